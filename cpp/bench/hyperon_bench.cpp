@@ -0,0 +1,288 @@
+// Benchmarks of the spaces, parser and interpreter
+//
+// Usage: hyperon_bench [--filter <substring>] [--sizes <n,n,...>]
+//                      [--min-time <seconds>] [--output <file>]
+//
+// Each benchmark is run for each size of the knowledge base until minimal
+// time is spent. Results are printed as a table and written as JSON into the
+// output file (stdout by default) to track regressions between releases.
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+// Benchmark prepares the data for the given size and returns the operation
+// to measure
+using Operation = std::function<void()>;
+using Benchmark = std::function<Operation(size_t size)>;
+
+struct BenchmarkInfo {
+    std::string name;
+    Benchmark benchmark;
+};
+
+struct Result {
+    std::string name;
+    size_t size;
+    uint64_t iterations;
+    double total_ns;
+};
+
+// Facts (isa obj<i> class<i % 10>) which are used as a knowledge base and as
+// unrelated atoms added to the interpreter knowledge bases
+static void add_facts(GroundingSpace& kb, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        kb.add_atom(E({ S("isa"), S("obj" + std::to_string(i)),
+                    S("class" + std::to_string(i % 10)) }));
+    }
+}
+
+static void add_if_definition(GroundingSpace& kb) {
+    kb.add_atom(E({ S("="), E({ S("if"), TRUE, V("then"), V("else") }), V("then") }));
+    kb.add_atom(E({ S("="), E({ S("if"), FALSE, V("then"), V("else") }), V("else") }));
+}
+
+static void add_factorial_definition(GroundingSpace& kb) {
+    add_if_definition(kb);
+    kb.add_atom(E({ S("="),
+                E({ S("fact"), V("n") }),
+                E({ S("if"), E({ EQ, Int(0), V("n") }),
+                        Int(1),
+                        E({ MUL,
+                                E({ S("fact"), E({ SUB, V("n"), Int(1) }) }),
+                                V("n") }) }) }));
+}
+
+static void add_fib_definition(GroundingSpace& kb) {
+    add_if_definition(kb);
+    kb.add_atom(E({ S("="),
+                E({ S("fib"), V("n") }),
+                E({ S("if"), E({ EQ, Int(0), V("n") }),
+                        Int(0),
+                        E({ S("if"), E({ EQ, Int(1), V("n") }),
+                            Int(1),
+                            E({ ADD,
+                                E({ S("fib"), E({ SUB, V("n"), Int(1) }) }),
+                                E({ S("fib"), E({ SUB, V("n"), Int(2) }) }) }) }) }) }));
+}
+
+static std::string program(size_t size) {
+    std::ostringstream text;
+    for (size_t i = 0; i < size; ++i) {
+        text << "(= (f" << i << " $x) (+ $x (* " << i << " (g $y))))\n";
+    }
+    return text.str();
+}
+
+static Operation interpret(std::shared_ptr<GroundingSpace> kb, AtomPtr expr, AtomPtr expected) {
+    return [kb, expr, expected]() -> void {
+        GroundingSpace target;
+        target.add_atom(expr);
+        AtomPtr result = interpret_until_result(target, *kb);
+        if (*result != *expected) {
+            throw std::runtime_error("Unexpected result: " + result->to_string());
+        }
+    };
+}
+
+static std::vector<BenchmarkInfo> const BENCHMARKS = {
+    { "match", [](size_t size) -> Operation {
+            auto kb = std::make_shared<GroundingSpace>();
+            add_facts(*kb, size);
+            AtomPtr pattern = E({ S("isa"), V("x"), S("class3") });
+            return [kb, pattern]() -> void { kb->match(pattern); };
+        } },
+    { "unify", [](size_t size) -> Operation {
+            auto kb = std::make_shared<GroundingSpace>();
+            for (size_t i = 0; i < size; ++i) {
+                kb->add_atom(E({ S("="), E({ S("f" + std::to_string(i)), V("x") }),
+                            E({ S("g"), V("x") }) }));
+            }
+            AtomPtr query = E({ S("="), E({ S("f" + std::to_string(size / 2)), S("a") }), V("X") });
+            return [kb, query]() -> void { kb->unify(query, true); };
+        } },
+    { "unify_generated", [](size_t size) -> Operation {
+            // Zipfian knowledge base with nested expressions and rules
+            KbGeneratorOptions options;
+            options.facts = size;
+            options.rules = size / 10;
+            options.depth = 3;
+            options.variables = 0.1;
+            auto kb = std::make_shared<GroundingSpace>();
+            KbGenerator generator(options);
+            generator.generate(*kb);
+            AtomPtr query = E({ S("="), generator.next_fact(), V("X") });
+            return [kb, query]() -> void { kb->unify(query, true); };
+        } },
+    { "interpret_factorial", [](size_t size) -> Operation {
+            auto kb = std::make_shared<GroundingSpace>();
+            add_factorial_definition(*kb);
+            add_facts(*kb, size);
+            return interpret(kb, E({ S("fact"), Int(5) }), Int(120));
+        } },
+    { "interpret_fib", [](size_t size) -> Operation {
+            auto kb = std::make_shared<GroundingSpace>();
+            add_fib_definition(*kb);
+            add_facts(*kb, size);
+            return interpret(kb, E({ S("fib"), Int(5) }), Int(5));
+        } },
+    { "text_space_parse", [](size_t size) -> Operation {
+            std::string text = program(size);
+            return [text]() -> void {
+                TextSpace parser;
+                parser.add_string(text);
+                GroundingSpace space;
+                space.add_from_space(parser);
+            };
+        } },
+    { "text_space_parse_parallel", [](size_t size) -> Operation {
+            // brackets are split by chars, quoted strings are matched by
+            // tokens only in the parsing threads
+            std::string text = program(size);
+            for (size_t i = 0; i < size; ++i) {
+                text += "(say \"a ) \\\" (\" 'b (')\n";
+            }
+            return [text]() -> void {
+                TextSpace parser;
+                parser.register_token(std::string("\"([^\"\\\\]|\\\\.)*\""),
+                        [](std::string token) -> AtomPtr { return S(token); });
+                parser.register_token(std::string("'[^']*'"),
+                        [](std::string token) -> AtomPtr { return S(token); });
+                parser.set_threads(4);
+                parser.add_string(text);
+                GroundingSpace space;
+                space.add_from_space(parser);
+            };
+        } },
+    { "atomese_parse", [](size_t size) -> Operation {
+            // many small snippets parsed one by one
+            std::vector<std::string> snippets;
+            for (size_t i = 0; i < size; ++i) {
+                snippets.push_back("(= (f" + std::to_string(i) + " $x) (+ $x 1))");
+            }
+            return [snippets]() -> void {
+                Atomese atomese;
+                GroundingSpace space;
+                for (auto const& snippet : snippets) {
+                    atomese.parse(snippet, space);
+                }
+            };
+        } },
+};
+
+static Result run(BenchmarkInfo const& info, size_t size, double min_time) {
+    using Clock = std::chrono::steady_clock;
+    Operation operation = info.benchmark(size);
+    // warm up
+    operation();
+    Result result{ info.name, size, 0, 0 };
+    uint64_t batch = 1;
+    while (result.total_ns < min_time * 1e9) {
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            operation();
+        }
+        result.total_ns += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        result.iterations += batch;
+        batch *= 2;
+    }
+    return result;
+}
+
+static void write_json(std::ostream& out, std::vector<Result> const& results) {
+    out << "{\"benchmarks\":[";
+    for (auto it = results.begin(); it != results.end(); ++it) {
+        out << (it == results.begin() ? "\n" : ",\n");
+        out << "{\"name\":\"" << it->name << "\",\"size\":" << it->size <<
+            ",\"iterations\":" << it->iterations <<
+            ",\"ns_per_op\":" << std::fixed << std::setprecision(1) <<
+            it->total_ns / it->iterations << "}";
+    }
+    out << "\n]}\n";
+}
+
+static std::vector<size_t> parse_sizes(std::string const& str) {
+    std::vector<size_t> sizes;
+    std::istringstream in(str);
+    std::string size;
+    while (std::getline(in, size, ',')) {
+        sizes.push_back(std::stoul(size));
+    }
+    return sizes;
+}
+
+static void usage() {
+    std::cerr << "Usage: hyperon_bench [--filter <substring>] [--sizes <n,n,...>]"
+        " [--min-time <seconds>] [--output <file>]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filter;
+    std::vector<size_t> sizes{ 10, 100, 1000 };
+    double min_time = 0.5;
+    std::string output;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                usage();
+                return 1;
+            }
+            if (arg == "--filter") {
+                filter = argv[++i];
+            } else if (arg == "--sizes") {
+                sizes = parse_sizes(argv[++i]);
+            } else if (arg == "--min-time") {
+                min_time = std::stod(argv[++i]);
+            } else if (arg == "--output") {
+                output = argv[++i];
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (std::logic_error const& e) {
+        usage();
+        return 1;
+    }
+
+    std::vector<Result> results;
+    std::cerr << std::left << std::setw(24) << "benchmark" << std::right <<
+        std::setw(10) << "size" << std::setw(12) << "iterations" <<
+        std::setw(16) << "ns/op" << std::endl;
+    for (auto const& info : BENCHMARKS) {
+        if (info.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        for (size_t size : sizes) {
+            Result result = run(info, size, min_time);
+            std::cerr << std::left << std::setw(24) << result.name << std::right <<
+                std::setw(10) << result.size << std::setw(12) << result.iterations <<
+                std::setw(16) << std::fixed << std::setprecision(1) <<
+                result.total_ns / result.iterations << std::endl;
+            results.push_back(result);
+        }
+    }
+
+    if (output.empty()) {
+        write_json(std::cout, results);
+    } else {
+        std::ofstream out(output);
+        write_json(out, results);
+        if (!out) {
+            std::cerr << "Could not write results into " << output << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
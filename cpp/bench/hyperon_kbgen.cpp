@@ -0,0 +1,84 @@
+// Generator of synthetic knowledge bases, see KbGenerator.h
+//
+// Usage: hyperon_kbgen [--facts <n>] [--rules <n>] [--symbols <n>]
+//                      [--skew <s>] [--depth <n>] [--arity <n>]
+//                      [--nesting <p>] [--variables <p>] [--seed <n>]
+//                      [--output <file>]
+//
+// Knowledge base is written as text, one atom per line, into the output
+// file (stdout by default).
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+static void usage() {
+    std::cerr << "Usage: hyperon_kbgen [--facts <n>] [--rules <n>] [--symbols <n>]"
+        " [--skew <s>] [--depth <n>] [--arity <n>] [--nesting <p>]"
+        " [--variables <p>] [--seed <n>] [--output <file>]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    KbGeneratorOptions options;
+    std::string output;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                usage();
+                return 1;
+            }
+            std::string value = argv[++i];
+            if (arg == "--facts") {
+                options.facts = std::stoull(value);
+            } else if (arg == "--rules") {
+                options.rules = std::stoull(value);
+            } else if (arg == "--symbols") {
+                options.symbols = std::stoull(value);
+            } else if (arg == "--skew") {
+                options.skew = std::stod(value);
+            } else if (arg == "--depth") {
+                options.depth = std::stoull(value);
+            } else if (arg == "--arity") {
+                options.arity = std::stoull(value);
+            } else if (arg == "--nesting") {
+                options.nesting = std::stod(value);
+            } else if (arg == "--variables") {
+                options.variables = std::stod(value);
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value);
+            } else if (arg == "--output") {
+                output = value;
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (std::logic_error const& e) {
+        usage();
+        return 1;
+    }
+
+    try {
+        KbGenerator generator(options);
+        if (output.empty()) {
+            generator.generate(std::cout);
+        } else {
+            std::ofstream out(output);
+            generator.generate(out);
+            out.flush();
+            if (!out) {
+                std::cerr << "Could not write knowledge base into " << output << std::endl;
+                return 1;
+            }
+        }
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
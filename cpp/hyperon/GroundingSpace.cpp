@@ -2,11 +2,18 @@
 
 #include <map>
 #include <memory>
+#include <sstream>
+#include <fstream>
 #include <algorithm>
 #include <stdexcept>
 #include <functional>
+#include <unordered_map>
 
 #include "logger_priv.h"
+#include "Serialization.h"
+#include "Tracer.h"
+#include "Metrics.h"
+#include "Profiler.h"
 
 // Atom
 
@@ -29,20 +36,166 @@ bool operator==(std::vector<AtomPtr> const& a, std::vector<AtomPtr> const& b) {
     return true;
 }
 
-std::string to_string(std::vector<AtomPtr> const& atoms, std::string delimiter) {
-    std::string str = "";
+void Atom::write_to(std::ostream& out) const {
+    out << to_string();
+}
+
+std::ostream& operator<<(std::ostream& out, Atom const& atom) {
+    atom.write_to(out);
+    return out;
+}
+
+void write_to(std::ostream& out, std::vector<AtomPtr> const& atoms, std::string const& delimiter) {
     for (auto it = atoms.begin(); it != atoms.end(); ++it) {
-        str += (it == atoms.begin() ? "" : delimiter) + (*it)->to_string();
+        if (it != atoms.begin()) {
+            out << delimiter;
+        }
+        (*it)->write_to(out);
+    }
+}
+
+std::string to_string(std::vector<AtomPtr> const& atoms, std::string delimiter) {
+    std::ostringstream out;
+    write_to(out, atoms, delimiter);
+    return out.str();
+}
+
+void SymbolAtom::write_to(std::ostream& out) const {
+    out << symbol;
+}
+
+void VariableAtom::write_to(std::ostream& out) const {
+    out << '$' << name;
+}
+
+// Deep expressions are compared, printed and released without recursion to
+// not overflow the stack
+
+ExprAtom::~ExprAtom() {
+    std::vector<AtomPtr> released;
+    auto release_children = [&released](std::vector<AtomPtr>& children) -> void {
+        for (auto& child : children) {
+            if (child.use_count() == 1 && child->get_type() == EXPR) {
+                released.push_back(std::move(child));
+            }
+        }
+    };
+    release_children(children);
+    while (!released.empty()) {
+        AtomPtr atom = std::move(released.back());
+        released.pop_back();
+        release_children(static_cast<ExprAtom&>(*atom).children);
     }
-    return str;
 }
 
 bool ExprAtom::operator==(Atom const& _other) const { 
-    if (_other.get_type() != EXPR) {
-        return false;
+    std::vector<std::pair<Atom const*, Atom const*>> stack{ { this, &_other } };
+    while (!stack.empty()) {
+        Atom const& a = *stack.back().first;
+        Atom const& b = *stack.back().second;
+        stack.pop_back();
+        if (a.get_type() != EXPR) {
+            if (a != b) {
+                return false;
+            }
+            continue;
+        }
+        if (b.get_type() != EXPR) {
+            return false;
+        }
+        if (&a == &b) {
+            continue;
+        }
+        auto const& children_a = static_cast<ExprAtom const&>(a).children;
+        auto const& children_b = static_cast<ExprAtom const&>(b).children;
+        if (children_a.size() != children_b.size()) {
+            return false;
+        }
+        for (size_t i = children_a.size(); i > 0; --i) {
+            stack.emplace_back(children_a[i - 1].get(), children_b[i - 1].get());
+        }
     }
-    ExprAtom const& other = static_cast<ExprAtom const&>(_other);
-    return children == other.children;
+    return true;
+}
+
+std::string ExprAtom::to_string() const {
+    std::ostringstream out;
+    write_to(out);
+    return out.str();
+}
+
+void ExprAtom::write_to(std::ostream& out) const {
+    out << '(';
+    std::vector<std::pair<ExprAtom const*, size_t>> stack{ { this, 0 } };
+    while (!stack.empty()) {
+        ExprAtom const* expr = stack.back().first;
+        size_t& next = stack.back().second;
+        if (next == expr->children.size()) {
+            out << ')';
+            stack.pop_back();
+            continue;
+        }
+        if (next > 0) {
+            out << ' ';
+        }
+        Atom const& child = *expr->children[next++];
+        if (child.get_type() == EXPR) {
+            out << '(';
+            stack.emplace_back(static_cast<ExprAtom const*>(&child), 0);
+        } else {
+            child.write_to(out);
+        }
+    }
+}
+
+void ExprAtom::collect_variable_mask() {
+    variable_mask = 0;
+    for (auto const& child : children) {
+        switch (child->get_type()) {
+            case VARIABLE:
+                variable_mask |= static_cast<VariableAtom const&>(*child).get_mask();
+                break;
+            case EXPR:
+                variable_mask |= static_cast<ExprAtom const&>(*child).variable_mask;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+std::vector<VariableAtomPtr> ExprAtom::get_variables() const {
+    std::vector<VariableAtomPtr> variables;
+    std::vector<ExprAtom const*> stack{ this };
+    while (!stack.empty()) {
+        ExprAtom const* expr = stack.back();
+        stack.pop_back();
+        for (auto const& child : expr->children) {
+            if (child->get_type() == VARIABLE) {
+                variables.push_back(std::static_pointer_cast<VariableAtom>(child));
+            } else if (child->get_type() == EXPR) {
+                ExprAtom const* sub = static_cast<ExprAtom const*>(child.get());
+                if (sub->has_variables()) {
+                    stack.push_back(sub);
+                }
+            }
+        }
+    }
+    if (variables.size() > 1) {
+        LessVariableAtomPtr less;
+        std::sort(variables.begin(), variables.end(), less);
+        variables.erase(std::unique(variables.begin(), variables.end(),
+                    [&less](VariableAtomPtr const& a, VariableAtomPtr const& b) -> bool {
+                        return !less(a, b) && !less(b, a);
+                    }), variables.end());
+    }
+    return variables;
+}
+
+ExprAtomPtr ExprAtom::with_child(size_t index, AtomPtr atom) const {
+    std::vector<AtomPtr> copy = children;
+    copy.at(index) = atom;
+    return E(std::move(copy));
 }
 
 // Grounding space
@@ -66,71 +219,138 @@ bool add_binding(Bindings& bindings, AtomPtr _var, AtomPtr value) {
     return true;
 }
 
-static bool match_atoms(AtomPtr a, AtomPtr b, MatchBindings& match) {
-    // TODO: it is not clear how should we handle the case when a and b are
-    // both variables. We can check variable name equality and skip binding. We
-    // can add a as binding for b and vice versa.
-    if (b->get_type() == Atom::VARIABLE) {
-        return add_binding(match.b_bindings, b, a);
-    }
-    switch (a->get_type()) {
-        case Atom::SYMBOL:
-        case Atom::GROUNDED:
-            return *a == *b;
-        case Atom::VARIABLE:
-            return add_binding(match.a_bindings, a, b);
-        case Atom::EXPR:
-            {
-                if (b->get_type() != Atom::EXPR) {
+// Pairs of atoms to be matched, children are pushed in reverse order to
+// visit them from left to right
+using MatchStack = std::vector<std::pair<AtomPtr const*, AtomPtr const*>>;
+
+static bool push_children(MatchStack& stack, AtomPtr const& a, AtomPtr const& b) {
+    auto const& children_a = static_cast<ExprAtom const&>(*a).get_children();
+    auto const& children_b = static_cast<ExprAtom const&>(*b).get_children();
+    if (children_a.size() != children_b.size()) {
+        return false;
+    }
+    for (size_t i = children_a.size(); i > 0; --i) {
+        stack.emplace_back(&children_a[i - 1], &children_b[i - 1]);
+    }
+    return true;
+}
+
+static bool match_atoms(AtomPtr const& _a, AtomPtr const& _b, MatchBindings& match) {
+    MatchStack stack{ { &_a, &_b } };
+    while (!stack.empty()) {
+        AtomPtr const& a = *stack.back().first;
+        AtomPtr const& b = *stack.back().second;
+        stack.pop_back();
+        // TODO: it is not clear how should we handle the case when a and b are
+        // both variables. We can check variable name equality and skip binding. We
+        // can add a as binding for b and vice versa.
+        if (b->get_type() == Atom::VARIABLE) {
+            if (!add_binding(match.b_bindings, b, a)) {
+                return false;
+            }
+            continue;
+        }
+        switch (a->get_type()) {
+            case Atom::SYMBOL:
+            case Atom::GROUNDED:
+                if (!(*a == *b)) {
                     return false;
                 }
-                std::vector<AtomPtr>& childrenA = std::static_pointer_cast<ExprAtom>(a)->get_children();
-                std::vector<AtomPtr>& childrenB = std::static_pointer_cast<ExprAtom>(b)->get_children();
-                if (childrenA.size() != childrenB.size()) {
+                break;
+            case Atom::VARIABLE:
+                if (!add_binding(match.a_bindings, a, b)) {
                     return false;
                 }
-                for (int i = 0; i < childrenA.size(); ++i) {
-                    if (!match_atoms(childrenA[i], childrenB[i], match)) {
-                        return false;
-                    }
+                break;
+            case Atom::EXPR:
+                if (b->get_type() != Atom::EXPR || !push_children(stack, a, b)) {
+                    return false;
                 }
-                return true;
-            }
-        default:
-            throw std::logic_error("Not implemented for type: " +
-                    to_string(a->get_type()));
+                break;
+            default:
+                throw std::logic_error("Not implemented for type: " +
+                        to_string(a->get_type()));
+        }
     }
+    return true;
 }
 
+static uint64_t get_variable_mask(Bindings const& bindings) {
+    uint64_t mask = 0;
+    for (auto const& binding : bindings) {
+        mask |= binding.first->get_mask();
+    }
+    return mask;
+}
+
+// Masks can intersect when none of the variables are bound, such
+// expressions are rebuilt into the same atoms
+static bool has_bound_variables(ExprAtom const& expr, uint64_t bindings_mask) {
+    return (expr.get_variable_mask() & bindings_mask) != 0;
+}
+
+// Expression which is being rebuilt by the non-recursive atom traversals:
+// children before next are already processed and stored into children
+struct RebuildFrame {
+    RebuildFrame(AtomPtr const& atom) : atom(atom), next(0), changed(false) {
+        if (atom->get_type() == Atom::EXPR) {
+            children.reserve(static_cast<ExprAtom const&>(*atom).get_children().size());
+        }
+    }
+    AtomPtr const& atom;
+    size_t next;
+    std::vector<AtomPtr> children;
+    bool changed;
+};
+
+// Returns original atom when none of its variables are bound
 static AtomPtr apply_bindings_to_atom(AtomPtr const& atom, Bindings const& bindings) {
-    switch (atom->get_type()) {
-        case Atom::SYMBOL:
-        case Atom::GROUNDED:
-            return atom;
-        case Atom::VARIABLE:
-            {
-                VariableAtomPtr var = std::static_pointer_cast<VariableAtom>(atom);
-                auto const& pair = bindings.find(var);
-                if (pair != bindings.end()) {
-                    return pair->second;
-                } else {
-                    return atom;
-                }
-            }
-        case Atom::EXPR:
-            {
-                ExprAtomPtr expr = std::static_pointer_cast<ExprAtom>(atom);
-                std::vector<AtomPtr> children;
-                for (auto const& atom : expr->get_children()) {
-                    AtomPtr applied = apply_bindings_to_atom(atom, bindings);
-                    children.push_back(applied);
-                }
-                AtomPtr grounded_expr = E(children);
-                return grounded_expr;
+    uint64_t bindings_mask = get_variable_mask(bindings);
+    std::vector<RebuildFrame> stack;
+    AtomPtr const* todo = &atom;
+    AtomPtr result;
+    while (true) {
+        if (todo) {
+            AtomPtr const& cur = *todo;
+            todo = nullptr;
+            switch (cur->get_type()) {
+                case Atom::SYMBOL:
+                case Atom::GROUNDED:
+                    result = cur;
+                    break;
+                case Atom::VARIABLE:
+                    {
+                        auto const& pair = bindings.find(std::static_pointer_cast<VariableAtom>(cur));
+                        result = pair != bindings.end() ? pair->second : cur;
+                        break;
+                    }
+                case Atom::EXPR:
+                    if (has_bound_variables(static_cast<ExprAtom const&>(*cur), bindings_mask)) {
+                        stack.emplace_back(cur);
+                    } else {
+                        result = cur;
+                    }
+                    break;
+                default:
+                    throw std::logic_error("Not implemented for type: " +
+                            to_string(cur->get_type()));
             }
-        default:
-            throw std::logic_error("Not implemented for type: " +
-                    to_string(atom->get_type()));
+        }
+        if (stack.empty()) {
+            return result;
+        }
+        RebuildFrame& top = stack.back();
+        auto const& children = static_cast<ExprAtom const&>(*top.atom).get_children();
+        if (top.children.size() < top.next) {
+            top.changed = top.changed || result != children[top.next - 1];
+            top.children.push_back(std::move(result));
+        }
+        if (top.next < children.size()) {
+            todo = &children[top.next++];
+        } else {
+            result = top.changed ? E(std::move(top.children)) : top.atom;
+            stack.pop_back();
+        }
     }
 }
 
@@ -145,28 +365,64 @@ static Bindings apply_bindings_to_bindings(Bindings from, Bindings to) {
 
 static void apply_bindings_to_templ(GroundingSpace& target,
         std::vector<AtomPtr> const& templ, Bindings const& bindings) {
+    std::vector<AtomPtr> results;
+    results.reserve(templ.size());
     for (auto const& atom : templ) {
         AtomPtr result = apply_bindings_to_atom(atom, bindings);
-        LOG_DEBUG << "result: " << result->to_string() << std::endl;
-        target.add_atom(result);
+        LOG_DEBUG << "result: " << *result << std::endl;
+        results.push_back(result);
     }
+    target.add_atoms(results);
 }
 
-std::vector<Bindings> GroundingSpace::match(AtomPtr pattern) const {
+std::vector<Bindings> match_candidates(std::vector<AtomPtr> const& candidates,
+        AtomPtr pattern) {
     std::vector<Bindings> result;
-    LOG_DEBUG << "pattern: " << pattern->to_string() << std::endl;
-    for (auto const& match : get_content()) {
+    LOG_DEBUG << "pattern: " << *pattern << std::endl;
+    Tracer::record(TraceEvent::MATCH_SCAN, pattern.get(), candidates.size());
+    bool profile = Profiler::is_enabled();
+    std::vector<Profiler::RuleTest> tests;
+    for (auto const& match : candidates) {
+        uint64_t start = profile ? Profiler::now() : 0;
         MatchBindings bindings;
-        if (!match_atoms(match, pattern, bindings)) {
-            continue;
+        bool matched = match_atoms(match, pattern, bindings);
+        if (matched) {
+            bindings.b_bindings = apply_bindings_to_bindings(bindings.a_bindings,
+                    bindings.b_bindings);
+            result.emplace_back(bindings.b_bindings);
+        }
+        if (profile) {
+            tests.push_back({ &match, matched, Profiler::now() - start });
         }
-        bindings.b_bindings = apply_bindings_to_bindings(bindings.a_bindings,
-                bindings.b_bindings);
-        result.emplace_back(bindings.b_bindings);
     }
+    if (profile) {
+        Profiler::add_rule_tests(tests);
+    }
+    Metrics::add_candidates(candidates.size(), result.size());
     return result;
 }
 
+bool MatchIterator::next(Bindings& bindings) {
+    uint64_t examined = 0;
+    while (index < candidates->size()) {
+        AtomPtr const& candidate = (*candidates)[index++];
+        ++examined;
+        MatchBindings match;
+        if (match_atoms(candidate, pattern, match)) {
+            bindings = apply_bindings_to_bindings(match.a_bindings, match.b_bindings);
+            Metrics::add_candidates(examined, 1);
+            return true;
+        }
+    }
+    Metrics::add_candidates(examined, 0);
+    return false;
+}
+
+std::vector<Bindings> GroundingSpace::match(AtomPtr pattern) const {
+    MetricsTimer timer(Metrics::Operation::MATCH);
+    return match_candidates(*content, pattern);
+}
+
 void GroundingSpace::match(SpaceAPI const& _pattern, SpaceAPI const& _templ, GroundingSpace& target) const {
     if (_pattern.get_type() != GroundingSpace::TYPE) {
         throw std::runtime_error("_pattern is expected to be GroundingSpace");
@@ -176,158 +432,403 @@ void GroundingSpace::match(SpaceAPI const& _pattern, SpaceAPI const& _templ, Gro
         throw std::runtime_error("_templ is expected to be GroundingSpace");
     }
     GroundingSpace const& templ = static_cast<GroundingSpace const&>(_templ);
-    if (pattern.content.size() != 1) {
+    if (pattern.content->size() != 1) {
         throw std::logic_error("_pattern with more than one clause is not supported");
     }
     LOG_DEBUG << "pattern: " << pattern.to_string() <<
         ", templ: " << templ.to_string() << std::endl;
-    AtomPtr pattern_atom = pattern.content[0];
+    AtomPtr pattern_atom = (*pattern.content)[0];
     std::vector<Bindings> results = match(pattern_atom);
     for (auto const& result : results) {
-        apply_bindings_to_templ(target, templ.content, result);
+        apply_bindings_to_templ(target, *templ.content, result);
     }
 }
 
 // Unify
 
-// FIXME: depth - is a hack for implementing unification with (= a b)
-// correctly; it should not be implemented here but on the caller level to keep
-// unify_atoms code clean
-bool unify_atoms(AtomPtr a, AtomPtr b, UnificationResult& result, int depth=0) {
-    // TODO: it is not clear how should we handle the case when a and b are
-    // both variables. We can check variable name equality and skip binding. We
-    // can add a as binding for b and vice versa.
-    if (b->get_type() == Atom::VARIABLE) {
-        // FIXME: hardcoding V("X") below is a hack to make work matching for
-        // (= (plus Z $y) $y) and (= (plus Z $n) $X), otherwise $y cannot be
-        // bound to $n and $X at same time, but bounding it to $X doesn't make
-        // sense anyway
-        if (a->get_type() == Atom::VARIABLE && *b != *V("X")) {
-            return add_binding(result.a_bindings, a, b)
-                && add_binding(result.b_bindings, b, a);
-        } else {
-            return add_binding(result.b_bindings, b, a);
-        }
+// Union-find based store of the variable bindings of both unified atoms.
+// Variables of the candidate (side A) and of the query (side B) are kept in
+// separate namespaces. Variables bound to each other are united into one
+// class, class root keeps the value. Values are kept in triangular form: they
+// can contain variables bound in the store, such variables are resolved on
+// extraction only. Each change is recorded in the trail and can be undone, so
+// a single store is reused while iterating over candidates and each
+// backtracking costs O(bindings changed).
+class BindingStore {
+public:
+    enum Side { A = 0, B = 1 };
+
+    BindingStore(bool occurs_check) : occurs_check(occurs_check) { }
+
+    size_t mark() const { return trail.size(); }
+    void undo(size_t mark);
+
+    bool bind(Side side, AtomPtr const& var, Side value_side, AtomPtr const& value);
+    bool unite(AtomPtr const& a_var, AtomPtr const& b_var);
+
+    AtomPtr resolve(Side side, AtomPtr const& atom) const;
+    Bindings get_bindings(Side side) const;
+
+private:
+    struct Node {
+        Node(Side side, VariableAtomPtr var, int index)
+            : side(side), var(var), parent(index), size(1), rep(index),
+            value_side(A) { }
+        Side side;
+        VariableAtomPtr var;
+        int parent;
+        int size;
+        // variable which represents the class when it has no value
+        int rep;
+        AtomPtr value;
+        Side value_side;
+    };
+
+    struct Change {
+        enum Kind { NEW_NODE, LINK, VALUE } kind;
+        int node;
+        int root;
+        int root_rep;
+    };
+
+    int get_node(Side side, AtomPtr const& var);
+    int find(int node) const;
+    int better_rep(int a, int b) const;
+    bool occurs(int root, Side side, AtomPtr const& atom) const;
+
+    bool occurs_check;
+    std::vector<Node> nodes;
+    std::unordered_map<std::string, int> index[2];
+    std::vector<Change> trail;
+};
+
+int BindingStore::get_node(Side side, AtomPtr const& _var) {
+    VariableAtomPtr var = std::static_pointer_cast<VariableAtom>(_var);
+    auto it = index[side].find(var->get_name());
+    if (it != index[side].end()) {
+        return it->second;
     }
-    switch (a->get_type()) {
-    case Atom::SYMBOL:
-    case Atom::GROUNDED:
-        if (b->get_type() == Atom::SYMBOL || b->get_type() == Atom::GROUNDED) {
-            return *a == *b;
-        }
-        result.unifications.emplace_back(a, b);
-        return true;
-    case Atom::VARIABLE:
-        return add_binding(result.a_bindings, a, b);
-    case Atom::EXPR:
-        if (b->get_type() == Atom::EXPR) {
-            ExprAtomPtr expr_a = std::static_pointer_cast<ExprAtom>(a);
-            ExprAtomPtr expr_b = std::static_pointer_cast<ExprAtom>(b);
-            if (expr_a->get_children().size() != expr_b->get_children().size()) {
-                if (depth == 1) {
-                    return false;
-                }
-                result.unifications.emplace_back(a, b);
-                return true;
-            }
-            for (int i = 0; i < expr_a->get_children().size(); ++i) {
-                if (!unify_atoms(expr_a->get_children()[i], expr_b->get_children()[i], result, depth+1)) {
-                    return false;
-                }
-            }
-        } else {
-            result.unifications.emplace_back(a, b);
-        }
-        return true;
-    default:
-        throw std::logic_error("Not implemented for type: " +
-                to_string(a->get_type()));
+    int node = nodes.size();
+    nodes.emplace_back(side, var, node);
+    index[side].emplace(var->get_name(), node);
+    trail.push_back({ Change::NEW_NODE, node, node, node });
+    return node;
+}
+
+// No path compression to keep undo cheap, union by size keeps trees
+// logarithmic
+int BindingStore::find(int node) const {
+    while (nodes[node].parent != node) {
+        node = nodes[node].parent;
     }
+    return node;
 }
 
-static void apply_bindings_to_unifications(UnificationResult& result) {
-    Unifications applied;
-    for (const auto& unification : result.unifications) {
-        AtomPtr a = apply_bindings_to_atom(unification.a, result.a_bindings);
-        AtomPtr b = apply_bindings_to_atom(unification.b, result.b_bindings);
-        applied.emplace_back(a, b);
+// Query variables are preferred to represent the class because result is
+// used in the query context, earlier variables are preferred among the
+// variables of the same side
+int BindingStore::better_rep(int a, int b) const {
+    if (nodes[a].side != nodes[b].side) {
+        return nodes[a].side == B ? a : b;
     }
-    result.unifications = applied;
+    return std::min(a, b);
 }
 
-std::vector<UnificationResult> GroundingSpace::unify(AtomPtr atom) const {
-    LOG_DEBUG << "match and unify atom: " << atom->to_string() << std::endl;
-    std::vector<UnificationResult> all_unifications;
-    for (auto const& candidate : get_content()) {
-        UnificationResult result;
-        if (!unify_atoms(candidate, atom, result)) {
-            LOG_TRACE << "candidate: " << candidate->to_string() << ": fail" << std::endl;
+bool BindingStore::occurs(int root, Side side, AtomPtr const& atom) const {
+    std::vector<std::pair<Side, VariableAtom const*>> stack;
+    auto push_variables = [&stack](Side side, AtomPtr const& atom) -> void {
+        if (atom->get_type() == Atom::VARIABLE) {
+            stack.emplace_back(side, static_cast<VariableAtom const*>(atom.get()));
+        } else if (atom->get_type() == Atom::EXPR) {
+            for (auto const& var : static_cast<ExprAtom const&>(*atom).get_variables()) {
+                stack.emplace_back(side, var.get());
+            }
+        }
+    };
+    std::vector<bool> visited(nodes.size(), false);
+    push_variables(side, atom);
+    while (!stack.empty()) {
+        Side var_side = stack.back().first;
+        auto it = index[var_side].find(stack.back().second->get_name());
+        stack.pop_back();
+        if (it == index[var_side].end()) {
             continue;
         }
-        LOG_DEBUG << "candidate: " << candidate->to_string() << ": ok" << std::endl;
-        result.b_bindings = apply_bindings_to_bindings(result.a_bindings,
-                result.b_bindings);
-        apply_bindings_to_unifications(result);
-        all_unifications.push_back(result);
+        int var_root = find(it->second);
+        if (var_root == root) {
+            return true;
+        }
+        if (!visited[var_root] && nodes[var_root].value) {
+            visited[var_root] = true;
+            push_variables(nodes[var_root].value_side, nodes[var_root].value);
+        }
     }
-    return all_unifications; 
+    return false;
 }
 
-// Interpret
-
-struct SubExpression {
-    static int NO_PARENT;
-    SubExpression(ExprAtomPtr expr, int parent_sub_index, int child_index)
-        : expr(expr) , parent_sub_index(parent_sub_index), child_index(child_index) { }
-    bool has_parent() const { return parent_sub_index != NO_PARENT; }
-    ExprAtomPtr expr;
-    int parent_sub_index;
-    int child_index;
-};
-
-int SubExpression::NO_PARENT = -1; 
-class ExpressionReduction : public GroundedAtom {
-public:
-
-    ExpressionReduction(GroundingSpace const& kb, ExprAtomPtr expr)
-        : kb(kb) { parse(expr, SubExpression::NO_PARENT, 0); }
-    ExpressionReduction(GroundingSpace const& kb, ExprAtomPtr full,
-            std::vector<SubExpression> subs)
-        : kb(kb), subs(subs) {}
+bool BindingStore::bind(Side side, AtomPtr const& var, Side value_side, AtomPtr const& value) {
+    int root = find(get_node(side, var));
+    if (nodes[root].value) {
+        return *nodes[root].value == *value;
+    }
+    if (occurs_check && occurs(root, value_side, value)) {
+        return false;
+    }
+    nodes[root].value = value;
+    nodes[root].value_side = value_side;
+    trail.push_back({ Change::VALUE, root, root, nodes[root].rep });
+    return true;
+}
 
-    void execute(GroundingSpace const& args, GroundingSpace& result) const override;
+bool BindingStore::unite(AtomPtr const& a_var, AtomPtr const& b_var) {
+    int a = find(get_node(A, a_var));
+    int b = find(get_node(B, b_var));
+    if (a == b) {
+        return true;
+    }
+    if (nodes[a].value && nodes[b].value) {
+        if (!(*nodes[a].value == *nodes[b].value)) {
+            return false;
+        }
+    } else if (occurs_check) {
+        if ((nodes[a].value && occurs(b, nodes[a].value_side, nodes[a].value))
+                || (nodes[b].value && occurs(a, nodes[b].value_side, nodes[b].value))) {
+            return false;
+        }
+    }
+    if (nodes[a].size < nodes[b].size) {
+        std::swap(a, b);
+    }
+    trail.push_back({ Change::LINK, b, a, nodes[a].rep });
+    nodes[b].parent = a;
+    nodes[a].size += nodes[b].size;
+    nodes[a].rep = better_rep(nodes[a].rep, nodes[b].rep);
+    if (!nodes[a].value && nodes[b].value) {
+        trail.push_back({ Change::VALUE, a, a, nodes[a].rep });
+        nodes[a].value = nodes[b].value;
+        nodes[a].value_side = nodes[b].value_side;
+    }
+    return true;
+}
 
-    bool operator==(Atom const& _other) const override {
-        ExpressionReduction const* other = dynamic_cast<ExpressionReduction const*>(&_other);
-        return other && *full() == *(other->full());
+void BindingStore::undo(size_t mark) {
+    while (trail.size() > mark) {
+        Change const& change = trail.back();
+        switch (change.kind) {
+            case Change::NEW_NODE:
+                index[nodes.back().side].erase(nodes.back().var->get_name());
+                nodes.pop_back();
+                break;
+            case Change::LINK:
+                nodes[change.node].parent = change.node;
+                nodes[change.root].size -= nodes[change.node].size;
+                nodes[change.root].rep = change.root_rep;
+                break;
+            case Change::VALUE:
+                nodes[change.node].value.reset();
+                break;
+        }
+        trail.pop_back();
     }
+}
 
-    std::string to_string() const override {
-        return "reduction " + full()->to_string();
+// Variables are replaced by values of their classes recursively, when class
+// has no value its representative variable is used. Classes which values are
+// being resolved are marked to prevent infinite loop on cyclic bindings when
+// occurs check is off.
+AtomPtr BindingStore::resolve(Side side, AtomPtr const& atom) const {
+    struct Frame : RebuildFrame {
+        Frame(AtomPtr const& atom, Side side, int root)
+            : RebuildFrame(atom), side(side), root(root) { }
+        Side side;
+        // class which value is resolved or -1 for expression frame
+        int root;
+    };
+    std::vector<Frame> stack;
+    std::vector<bool> resolving(nodes.size(), false);
+    AtomPtr const* todo = &atom;
+    Side todo_side = side;
+    AtomPtr result;
+    while (true) {
+        if (todo) {
+            AtomPtr const& cur = *todo;
+            todo = nullptr;
+            if (cur->get_type() == Atom::VARIABLE) {
+                VariableAtom const& var = static_cast<VariableAtom const&>(*cur);
+                auto it = index[todo_side].find(var.get_name());
+                if (it == index[todo_side].end()) {
+                    result = cur;
+                } else {
+                    int root = find(it->second);
+                    Node const& node = nodes[root];
+                    if (!node.value || resolving[root]) {
+                        result = nodes[node.rep].var;
+                    } else {
+                        resolving[root] = true;
+                        stack.emplace_back(cur, todo_side, root);
+                        todo = &node.value;
+                        todo_side = node.value_side;
+                        continue;
+                    }
+                }
+            } else if (cur->get_type() == Atom::EXPR
+                    && static_cast<ExprAtom const&>(*cur).has_variables()) {
+                stack.emplace_back(cur, todo_side, -1);
+            } else {
+                result = cur;
+            }
+        }
+        if (stack.empty()) {
+            return result;
+        }
+        Frame& top = stack.back();
+        if (top.root >= 0) {
+            resolving[top.root] = false;
+            stack.pop_back();
+            continue;
+        }
+        auto const& children = static_cast<ExprAtom const&>(*top.atom).get_children();
+        if (top.children.size() < top.next) {
+            top.changed = top.changed || result != children[top.next - 1];
+            top.children.push_back(std::move(result));
+        }
+        if (top.next < children.size()) {
+            todo = &children[top.next++];
+            todo_side = top.side;
+        } else {
+            result = top.changed ? E(std::move(top.children)) : top.atom;
+            stack.pop_back();
+        }
     }
+}
 
-private:
-    void parse(ExprAtomPtr expr, int parent_sub_index, int child_index);
-    std::shared_ptr<ExpressionReduction> pop_sub(SubExpression sub, AtomPtr replacement) const;
-    ExprAtomPtr full() const { return subs[0].expr; }
-    void replace_sub(SubExpression& sub, AtomPtr replacement);
+Bindings BindingStore::get_bindings(Side side) const {
+    Bindings bindings;
+    for (auto const& node : nodes) {
+        if (node.side == side) {
+            bindings[node.var] = resolve(side, node.var);
+        }
+    }
+    return bindings;
+}
 
-    GroundingSpace const& kb;
-    std::vector<SubExpression> subs;
-};
+// FIXME: depth - is a hack for implementing unification with (= a b)
+// correctly; it should not be implemented here but on the caller level to keep
+// unify_atoms code clean
+static bool unify_atoms(AtomPtr const& _a, AtomPtr const& _b, BindingStore& store,
+        Unifications& unifications) {
+    struct Pair {
+        AtomPtr const* a;
+        AtomPtr const* b;
+        int depth;
+    };
+    std::vector<Pair> stack{ { &_a, &_b, 0 } };
+    while (!stack.empty()) {
+        AtomPtr const& a = *stack.back().a;
+        AtomPtr const& b = *stack.back().b;
+        int depth = stack.back().depth;
+        stack.pop_back();
+        bool ok = true;
+        if (b->get_type() == Atom::VARIABLE) {
+            if (a->get_type() == Atom::VARIABLE) {
+                ok = store.unite(a, b);
+            } else {
+                ok = store.bind(BindingStore::B, b, BindingStore::A, a);
+            }
+        } else {
+            switch (a->get_type()) {
+            case Atom::SYMBOL:
+            case Atom::GROUNDED:
+                if (b->get_type() == Atom::SYMBOL || b->get_type() == Atom::GROUNDED) {
+                    ok = *a == *b;
+                } else {
+                    unifications.emplace_back(a, b);
+                }
+                break;
+            case Atom::VARIABLE:
+                ok = store.bind(BindingStore::A, a, BindingStore::B, b);
+                break;
+            case Atom::EXPR:
+                if (b->get_type() == Atom::EXPR) {
+                    auto const& children_a = static_cast<ExprAtom const&>(*a).get_children();
+                    auto const& children_b = static_cast<ExprAtom const&>(*b).get_children();
+                    if (children_a.size() != children_b.size()) {
+                        ok = depth != 1;
+                        if (ok) {
+                            unifications.emplace_back(a, b);
+                        }
+                    } else {
+                        for (size_t i = children_a.size(); i > 0; --i) {
+                            stack.push_back({ &children_a[i - 1], &children_b[i - 1], depth + 1 });
+                        }
+                    }
+                } else {
+                    unifications.emplace_back(a, b);
+                }
+                break;
+            default:
+                throw std::logic_error("Not implemented for type: " +
+                        to_string(a->get_type()));
+            }
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
 
-void ExpressionReduction::parse(ExprAtomPtr expr, int parent_sub_index, int child_index) {
-    int expr_sub_index = subs.size();
-    subs.emplace_back(expr, parent_sub_index, child_index);
-    auto const& children = expr->get_children();
-    for (int i = 0; i < children.size(); ++i) {
-        AtomPtr child = children[i];
-        if (child->get_type() == Atom::EXPR) {
-            parse(std::static_pointer_cast<ExprAtom>(child), expr_sub_index, i);
+std::vector<UnificationResult> unify_candidates(std::vector<AtomPtr> const& candidates,
+        AtomPtr atom, bool occurs_check) {
+    LOG_DEBUG << "match and unify atom: " << *atom << std::endl;
+    Tracer::record(TraceEvent::MATCH_SCAN, atom.get(), candidates.size());
+    std::vector<UnificationResult> all_unifications;
+    BindingStore store(occurs_check);
+    Unifications unifications;
+    bool profile = Profiler::is_enabled();
+    std::vector<Profiler::RuleTest> tests;
+    for (auto const& candidate : candidates) {
+        uint64_t start = profile ? Profiler::now() : 0;
+        unifications.clear();
+        if (!unify_atoms(candidate, atom, store, unifications)) {
+            LOG_TRACE << "candidate: " << *candidate << ": fail" << std::endl;
+            store.undo(0);
+            if (profile) {
+                tests.push_back({ &candidate, false, Profiler::now() - start });
+            }
+            continue;
+        }
+        LOG_DEBUG << "candidate: " << *candidate << ": ok" << std::endl;
+        UnificationResult result;
+        result.candidate = candidate;
+        result.a_bindings = store.get_bindings(BindingStore::A);
+        result.b_bindings = store.get_bindings(BindingStore::B);
+        result.unifications.reserve(unifications.size());
+        for (auto const& unification : unifications) {
+            result.unifications.emplace_back(
+                    store.resolve(BindingStore::A, unification.a),
+                    store.resolve(BindingStore::B, unification.b));
         }
+        all_unifications.push_back(std::move(result));
+        store.undo(0);
+        if (profile) {
+            tests.push_back({ &candidate, true, Profiler::now() - start });
+        }
+    }
+    if (profile) {
+        Profiler::add_rule_tests(tests);
     }
+    Metrics::add_candidates(candidates.size(), all_unifications.size());
+    return all_unifications; 
 }
 
+std::vector<UnificationResult> GroundingSpace::unify(AtomPtr atom, bool occurs_check) const {
+    MetricsTimer timer(Metrics::Operation::UNIFY);
+    return unify_candidates(*content, atom, occurs_check);
+}
+
+// Interpret
+
 struct ExecutionResult {
     bool success;
     std::vector<AtomPtr> results;
@@ -339,13 +840,16 @@ static bool is_grounded_expression(ExprAtomPtr expr) {
 
 static ExecutionResult execute_grounded_expression(ExprAtomPtr expr) {
     GroundedAtom const* func = static_cast<GroundedAtom const*>(expr->get_children()[0].get());
+    TraceSpan span(TraceEvent::GROUNDED_CALL_BEGIN, func);
     // TODO: How should we return results of the execution? At the moment they
     // are put into current atomspace. Should we return new child atomspace
     // instead?
     auto children = expr->get_children();
     GroundingSpace args(children);
     LOG_DEBUG << "args: \"" << args.to_string() << "\"" << std::endl;
-    GroundingSpace results;
+    GroundingSpace results = GroundingSpace::scratch();
+    bool profile = Profiler::is_enabled();
+    uint64_t start = profile ? Profiler::now() : 0;
     try {
         func->execute(args, results);
     } catch (...) {
@@ -353,109 +857,19 @@ static ExecutionResult execute_grounded_expression(ExprAtomPtr expr) {
         // add new type for error; this is the case for
         // IllegalArgumentExpression analogue
         LOG_DEBUG << "error while executing expression" << std::endl;
+        if (profile) {
+            Profiler::add_grounded_call(children[0], true, 0, Profiler::now() - start);
+        }
         return { true, std::vector<AtomPtr>() };
     }
+    if (profile) {
+        Profiler::add_grounded_call(children[0], false,
+                results.get_content().size(), Profiler::now() - start);
+    }
     LOG_DEBUG << "results: \"" << results.to_string() << "\"" << std::endl;
     return { true, results.get_content() };
 }
 
-static AtomPtr match_plain_nongrounded_expression(GroundingSpace const& kb, ExprAtomPtr expr, AtomPtr templ, GroundingSpace& target) {
-    LOG_DEBUG << "looking for expression in KB: " << expr->to_string() << std::endl;
-    std::vector<Bindings> results = kb.match(E({ S("="), expr, V("X") }));
-    std::vector<AtomPtr> _templ({ templ });
-    for (auto const& result : results) {
-        apply_bindings_to_templ(target, _templ, result);
-    }
-    return results.empty() ? expr : Atom::INVALID;
-}
-
-static AtomPtr interpret_full_expression(GroundingSpace const& kb, ExprAtomPtr expr, GroundingSpace& target) {
-    if (is_grounded_expression(expr)) {
-        ExecutionResult result = execute_grounded_expression(expr);
-        if (result.success) {
-            for (auto const& result : result.results) {
-                target.add_atom(result);
-            }
-            return Atom::INVALID;
-        } else {
-            return expr;
-        }
-    } else {
-        return match_plain_nongrounded_expression(kb, expr, V("X"), target);
-    }
-}
-
-void ExpressionReduction::execute(GroundingSpace const& args, GroundingSpace& target) const {
-    SubExpression const& sub = subs.back();
-    if (!sub.has_parent()) {
-        LOG_DEBUG << "full expression: " << sub.expr->to_string() << std::endl;
-        AtomPtr non_interpretable = interpret_full_expression(kb, sub.expr, target);
-        if (non_interpretable) {
-            target.add_atom(non_interpretable);
-        }
-    } else {
-        LOG_DEBUG << "sub expression: " << sub.expr->to_string() << std::endl;
-        if (is_grounded_expression(sub.expr)) {
-            ExecutionResult result = execute_grounded_expression(sub.expr);
-            if (result.success) {
-                if (result.results.empty()) {
-                    throw std::runtime_error("Grounded expression: " +
-                            sub.expr->to_string() +
-                            " returned nothing while being part of large expression: " +
-                            full()->to_string());
-                }
-                for (auto const& result : result.results) {
-                    target.add_atom(E({ pop_sub(sub, result) }));
-                }
-            } else {
-                target.add_atom(E({ pop_sub(sub, Atom::INVALID) }));
-            }
-        } else {
-            GroundingSpace results;
-            // FIXME: hack temporary replace expr by variable to form pattern
-            subs[sub.parent_sub_index].expr->get_children()[sub.child_index] = V("X");
-            AtomPtr non_interpretable = match_plain_nongrounded_expression(kb, sub.expr, full(), results);
-            subs[sub.parent_sub_index].expr->get_children()[sub.child_index] = sub.expr;
-            if (non_interpretable) {
-                target.add_atom(E({ pop_sub(sub, Atom::INVALID) }));
-                return;
-            }
-            for (auto const& result : results.get_content()) {
-                ExprAtomPtr expr = std::static_pointer_cast<ExprAtom>(result);
-                // FIXME: ineffective we parse expression each time even if
-                // no variables were replaced
-                target.add_atom(E({std::make_shared<ExpressionReduction>(kb, expr)}));
-            }   
-        }
-    }
-}
-
-void ExpressionReduction::replace_sub(SubExpression& sub, AtomPtr replacement) {
-    SubExpression& parent_sub = subs[sub.parent_sub_index];
-    ExprAtomPtr parent_copy = E(parent_sub.expr->get_children());  
-    parent_copy->get_children()[sub.child_index] = replacement;
-    if (parent_sub.has_parent()) {
-        subs[sub.parent_sub_index].expr->get_children()[sub.child_index] = replacement;
-    }
-    parent_sub.expr = parent_copy;
-}
-
-std::shared_ptr<ExpressionReduction> ExpressionReduction::pop_sub(SubExpression sub, AtomPtr tail) const {
-    // TODO: replace copy by reusing array with variable containing size
-    std::vector<SubExpression> subs_copy = subs;
-    subs_copy.pop_back();
-    auto copy = std::make_shared<ExpressionReduction>(kb, full(), subs_copy);
-    if (tail) {
-        copy->replace_sub(sub, tail);
-        if (tail->get_type() == Atom::EXPR) {
-            ExprAtomPtr expr = std::static_pointer_cast<ExprAtom>(tail);
-            copy->parse(expr, sub.parent_sub_index, sub.child_index);
-            return copy;
-        }
-    }
-    return copy;
-}
-
 static bool is_plain_expression(ExprAtomPtr expr) {
     for (auto const& child : expr->get_children()) {
         if (child->get_type() == Atom::EXPR) {
@@ -488,54 +902,230 @@ public:
 
 const GroundedAtomPtr IFMATCH = std::make_shared<IfMatchAtom>();
 
+void GroundingSpace::add_native(const SpaceAPI* _other) {
+    GroundingSpace const* other = dynamic_cast<GroundingSpace const*>(_other);
+    if (!other) {
+        throw std::logic_error(_other->get_type() + " cannot be added natively to " + TYPE);
+    }
+    // content is shared while atoms are added, so it is not changed even
+    // when space is added to itself
+    std::shared_ptr<std::vector<AtomPtr> const> atoms = other->content;
+    add_atoms(*atoms);
+}
+
+static struct RegisterGroundingSpaceConverters {
+    RegisterGroundingSpaceConverters() {
+        register_space_converter<GroundingSpace, GroundingSpace>(
+                [](GroundingSpace const& from, GroundingSpace& to) -> void {
+                    to.add_native(&from);
+                });
+        register_atom_source<GroundingSpace>(
+                [](GroundingSpace const& space, AtomSink const& sink) -> void {
+                    for (auto const& atom : space.get_content()) {
+                        sink(atom);
+                    }
+                });
+        register_atom_sink<GroundingSpace>(
+                [](GroundingSpace& space) -> AtomSink {
+                    return [&space](AtomPtr atom) -> void { space.add_atom(atom); };
+                });
+    }
+} register_grounding_space_converters;
+
+static struct RegisterIfMatchCodec {
+    RegisterIfMatchCodec() {
+        register_grounded_atom("IFMATCH", IFMATCH);
+    }
+} register_ifmatch_codec;
+
 const SymbolAtomPtr REDUCT = S("reduct");
 // FIXME: make AT symbol more unique
 const SymbolAtomPtr AT = S("@");
 
-static bool find_next_expr(std::vector<AtomPtr>::iterator& it,
-        std::vector<AtomPtr>::const_iterator end) {
-    while (it != end) {
-        if ((*it)->get_type() == Atom::EXPR) {
-            return true;
-        }
-        it++;
+// Reduction frame is an expression which argument is being reduced and the
+// index of this argument. Frames are immutable and linked into the chain from
+// the innermost frame to the full expression, so reductions produced from
+// the same state share their context. Descending into an argument and
+// plugging the value back cost O(arity) and don't copy other parts of the
+// full expression.
+struct ReductionFrame;
+using ReductionFramePtr = std::shared_ptr<ReductionFrame const>;
+
+struct ReductionFrame {
+    ReductionFrame(ExprAtomPtr expr, size_t index, ReductionFramePtr parent)
+        : expr(expr), index(index), parent(parent) { }
+    ~ReductionFrame();
+
+    // argument at index is stale, it is replaced by the value when the
+    // argument is reduced
+    ExprAtomPtr expr;
+    size_t index;
+    ReductionFramePtr parent;
+};
+
+ReductionFrame::~ReductionFrame() {
+    // release long chains iteratively to not overflow the stack
+    ReductionFramePtr next = std::move(parent);
+    while (next && next.use_count() == 1) {
+        ReductionFramePtr tail = std::move(const_cast<ReductionFrame&>(*next).parent);
+        next = std::move(tail);
     }
-    return false;
 }
 
-static AtomPtr reduct_first_arg(ExprAtomPtr expr) {
-    std::vector<AtomPtr> children = expr->get_children();
-    auto it = children.begin();
-    if (!find_next_expr(it, children.end())) {
-        throw std::runtime_error("Could not find first expression argument");
+// Reduction is a state of the expression interpretation which is kept in the
+// target space between interpretation steps. It is an atom under
+// interpretation (focus) and the chain of frames the value of the focus
+// should be plugged into. Reducted focus is an expression which arguments
+// are reduced already.
+class ReductionAtom : public GroundedAtom {
+public:
+    ReductionAtom(AtomPtr focus, bool reducted, ReductionFramePtr frame)
+        : focus(focus), reducted(reducted), frame(frame) { }
+    virtual ~ReductionAtom() { }
+
+    void execute(GroundingSpace const& args, GroundingSpace& result) const override {
+        throw std::logic_error("Reduction cannot be executed");
+    }
+
+    bool operator==(Atom const& other) const override;
+    std::string to_string() const override;
+    void write_to(std::ostream& out) const override;
+
+    AtomPtr const focus;
+    bool const reducted;
+    ReductionFramePtr const frame;
+};
+
+static bool equal_except(ExprAtom const& a, ExprAtom const& b, size_t index) {
+    auto const& a_children = a.get_children();
+    auto const& b_children = b.get_children();
+    if (a_children.size() != b_children.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a_children.size(); ++i) {
+        if (i != index && !(*a_children[i] == *b_children[i])) {
+            return false;
+        }
     }
-    AtomPtr arg = *it;
-    *it = AT;
-    return E({REDUCT, arg, E(children)});
+    return true;
 }
 
-static AtomPtr reduct_next_arg(ExprAtomPtr expr, AtomPtr value) {
-    std::vector<AtomPtr> children = expr->get_children();
-    auto it = children.begin();
-    bool ifmatch = *it == IFMATCH;
-    while (it != children.end()) {
-        if (*it == AT) {
-            *it = value;
-            break;
+bool ReductionAtom::operator==(Atom const& _other) const {
+    ReductionAtom const* other = dynamic_cast<ReductionAtom const*>(&_other);
+    if (!other || reducted != other->reducted || !(*focus == *other->focus)) {
+        return false;
+    }
+    ReductionFrame const* a = frame.get();
+    ReductionFrame const* b = other->frame.get();
+    while (a && b && a != b) {
+        if (a->index != b->index || !equal_except(*a->expr, *b->expr, a->index)) {
+            return false;
         }
-        it++;
+        a = a->parent.get();
+        b = b->parent.get();
     }
-    if (it == expr->get_children().end()) {
-        throw std::runtime_error("Could not find placeholder to replace by value");
+    return a == b;
+}
+
+// Prints reduction in the (reduct <sub> <full>) form where position of the
+// sub expression is marked by @
+std::string ReductionAtom::to_string() const {
+    std::ostringstream out;
+    write_to(out);
+    return out.str();
+}
+
+void ReductionAtom::write_to(std::ostream& out) const {
+    for (ReductionFrame const* cur = frame.get(); cur; cur = cur->parent.get()) {
+        out << '(' << *REDUCT << ' ';
     }
-    it++;
-    if (find_next_expr(it, children.end()) && (!ifmatch || it <= (children.begin() + 2))) {
-        AtomPtr arg = *it;
-        *it = AT;
-        return E({REDUCT, arg, E(children)});
+    if (reducted) {
+        out << '(' << *REDUCT << ' ' << *focus << ')';
     } else {
-        return E({REDUCT, E(children)});
+        out << *focus;
+    }
+    for (ReductionFrame const* cur = frame.get(); cur; cur = cur->parent.get()) {
+        out << ' ' << *cur->expr->with_child(cur->index, AT) << ')';
+    }
+}
+
+static AtomPtr make_reduction(AtomPtr focus, bool reducted, ReductionFramePtr frame) {
+    if (!reducted && !frame) {
+        return focus;
+    }
+    return std::make_shared<ReductionAtom>(focus, reducted, frame);
+}
+
+static AtomPtr reduct_first_arg(ExprAtomPtr expr, ReductionFramePtr const& frame) {
+    auto const& children = expr->get_children();
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i]->get_type() == Atom::EXPR) {
+            return make_reduction(children[i], false,
+                    std::make_shared<ReductionFrame>(expr, i, frame));
+        }
+    }
+    throw std::runtime_error("Could not find first expression argument");
+}
+
+static AtomPtr reduct_next_arg(ReductionFrame const& frame, AtomPtr value) {
+    ExprAtomPtr expr = frame.expr->with_child(frame.index, value);
+    auto const& children = expr->get_children();
+    bool ifmatch = children[0] == IFMATCH;
+    for (size_t i = frame.index + 1; i < children.size(); ++i) {
+        if (children[i]->get_type() == Atom::EXPR) {
+            if (ifmatch && i > 2) {
+                break;
+            }
+            return make_reduction(children[i], false,
+                    std::make_shared<ReductionFrame>(expr, i, frame.parent));
+        }
+    }
+    return make_reduction(expr, true, frame.parent);
+}
+
+static ExprAtomPtr apply_bindings_to_frame(ReductionFrame const& frame, Bindings const& bindings) {
+    ExprAtomPtr const& expr = frame.expr;
+    if (!has_bound_variables(*expr, get_variable_mask(bindings))) {
+        return expr;
+    }
+    auto const& children = expr->get_children();
+    std::vector<AtomPtr> applied;
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (i == frame.index) {
+            continue;
+        }
+        AtomPtr child = apply_bindings_to_atom(children[i], bindings);
+        if (child != children[i] && applied.empty()) {
+            applied = children;
+        }
+        if (!applied.empty()) {
+            applied[i] = child;
+        }
+    }
+    return applied.empty() ? expr : E(std::move(applied));
+}
+
+static ReductionFramePtr apply_bindings_to_frames(ReductionFramePtr const& frame,
+        Bindings const& bindings) {
+    std::vector<ReductionFrame const*> frames;
+    std::vector<ExprAtomPtr> applied;
+    for (ReductionFrame const* cur = frame.get(); cur; cur = cur->parent.get()) {
+        frames.push_back(cur);
+        applied.push_back(apply_bindings_to_frame(*cur, bindings));
+    }
+    // frames outside of the outermost changed one are shared
+    size_t outer = frames.size();
+    while (outer > 0 && applied[outer - 1] == frames[outer - 1]->expr) {
+        --outer;
     }
+    if (outer == 0) {
+        return frame;
+    }
+    ReductionFramePtr result = frames[outer - 1]->parent;
+    for (size_t i = outer; i-- > 0; ) {
+        result = std::make_shared<ReductionFrame>(applied[i], frames[i]->index, result);
+    }
+    return result;
 }
 
 static AtomPtr generate_if_eq_recursively(Unifications::const_reverse_iterator i,
@@ -553,41 +1143,15 @@ static AtomPtr unification_result_to_expr(UnificationResult const& unification_r
     return generate_if_eq_recursively(it, unification_result.unifications.crend(), value);
 }
 
-static AtomPtr interpret_expr_step(GroundingSpace const& kb,
-    AtomPtr atom, bool reducted, std::function<void(AtomPtr, Bindings const*)> callback) {
-    LOG_DEBUG << "interpreting atom: " << atom->to_string() << std::endl;
+static AtomPtr interpret_expr_step(KnowledgeBase const& kb, AtomPtr atom,
+        bool reducted, ReductionFramePtr const& frame,
+        std::function<void(AtomPtr)> callback) {
+    LOG_DEBUG << "interpreting atom: " << *atom << std::endl;
     if (atom->get_type() != Atom::EXPR) {
         return atom;
     }
     ExprAtomPtr expr = std::static_pointer_cast<ExprAtom>(atom);
-    AtomPtr op = expr->get_children()[0];
-    if (op == REDUCT) {
-        AtomPtr sub_expr = expr->get_children()[1];
-        if (expr->get_children().size() < 3) {
-            LOG_DEBUG << "interpreting expression after reduction" << std::endl;
-            return interpret_expr_step(kb, sub_expr,
-                    true, [&callback](AtomPtr result, Bindings const* bindings) -> void {
-                        callback(result, bindings);
-                    });
-        } else {
-            LOG_DEBUG << "interpret sub expression" << std::endl;
-            ExprAtomPtr full_expr = std::static_pointer_cast<ExprAtom>(expr->get_children()[2]);
-            AtomPtr result = interpret_expr_step(kb, sub_expr,
-                    false, [&callback, &full_expr](AtomPtr result, Bindings const* bindings) -> void {
-                        AtomPtr applied = full_expr;
-                        if (bindings) {
-                            LOG_DEBUG << "apply bindings to full_expr" << std::endl;
-                            applied = apply_bindings_to_atom(full_expr, *bindings);
-                        }
-                        callback(E({ REDUCT, result, applied }), bindings);
-                    });
-            if (result) {
-                LOG_DEBUG << "sub expression is not interpretable" << std::endl;
-                callback(reduct_next_arg(full_expr, result), nullptr);
-            }
-            return Atom::INVALID;
-        }
-    } else if (is_grounded_expression(expr)) {
+    if (is_grounded_expression(expr)) {
         LOG_DEBUG << "executing grounded expression" << std::endl;
         if (is_plain_expression(expr) || reducted) {
             LOG_DEBUG << "executing " << (reducted ? "reducted" : "plain") <<
@@ -595,8 +1159,8 @@ static AtomPtr interpret_expr_step(GroundingSpace const& kb,
             ExecutionResult result = execute_grounded_expression(expr);
             if (result.success) {
                 for (auto const& result : result.results) {
-                    LOG_DEBUG << "execution result: " << result->to_string() << std::endl;
-                    callback(result, nullptr);
+                    LOG_DEBUG << "execution result: " << *result << std::endl;
+                    callback(make_reduction(result, false, frame));
                 }
                 return Atom::INVALID;
             } else {
@@ -605,14 +1169,14 @@ static AtomPtr interpret_expr_step(GroundingSpace const& kb,
             }
         } else {
             LOG_DEBUG << "reducting expression" << std::endl;
-            callback(reduct_first_arg(expr), nullptr);
+            callback(reduct_first_arg(expr, frame));
             return Atom::INVALID;
         }
     } else {
         LOG_DEBUG << "interpreting symbolic expression" << std::endl;
         // FIXME: replace V("X") by UniqueVar
         VariableAtomPtr var = V("X");
-        std::vector<UnificationResult> results = kb.unify(E({S("="), expr, var}));
+        std::vector<UnificationResult> results = kb.unify(E({S("="), expr, var}), true);
         if (results.empty()) {
             LOG_DEBUG << "unification is not found" << std::endl;
             if (is_plain_expression(expr) || reducted) {
@@ -621,15 +1185,21 @@ static AtomPtr interpret_expr_step(GroundingSpace const& kb,
                 return expr;
             } else {
                 LOG_DEBUG << "reducting expression" << std::endl;
-                callback(reduct_first_arg(expr), nullptr);
+                callback(reduct_first_arg(expr, frame));
                 return Atom::INVALID;
             }
         } else {
             LOG_DEBUG << "adding unification results" << std::endl; 
+            Tracer::record(TraceEvent::RULES_MATCHED, expr.get(), results.size());
+            if (Profiler::is_enabled()) {
+                Profiler::add_rule_results(results);
+            }
             for (auto const& result : results) {
                 auto value = result.b_bindings.find(var);
                 if (value != result.b_bindings.end()) {
-                    callback(unification_result_to_expr(result, var), &result.b_bindings);
+                    LOG_DEBUG << "apply bindings to reduction frames" << std::endl;
+                    callback(make_reduction(unification_result_to_expr(result, var),
+                                false, apply_bindings_to_frames(frame, result.b_bindings)));
                 } else {
                     throw std::runtime_error("No value for " + var->to_string() + " var");
                 }
@@ -640,23 +1210,138 @@ static AtomPtr interpret_expr_step(GroundingSpace const& kb,
 }
 
 AtomPtr GroundingSpace::interpret_step(SpaceAPI const& _kb) {
-    if (_kb.get_type() != GroundingSpace::TYPE) {
-        throw std::runtime_error("Only " + GroundingSpace::TYPE +
-                " knowledge bases are supported");
+    MetricsTimer timer(Metrics::Operation::INTERPRET_STEP);
+    KnowledgeBase const* kb = dynamic_cast<KnowledgeBase const*>(&_kb);
+    if (!kb) {
+        throw std::runtime_error(_kb.get_type() +
+                " cannot be used as a knowledge base");
     }
-    GroundingSpace const& kb = static_cast<GroundingSpace const&>(_kb);
 
-    if (content.empty()) {
+    if (content->empty()) {
         return S("eos");
     }
 
-    AtomPtr atom = content.back();
-    content.pop_back();
-    LOG_DEBUG << "next atom: " << atom->to_string() << std::endl;
-    return interpret_expr_step(kb, atom, false, [this](AtomPtr result, Bindings const* bindings) -> void {
-                LOG_DEBUG << "push atom: " << result->to_string() << std::endl;
-                this->content.push_back(result);
-            });
+    AtomPtr atom = pop_atom();
+    LOG_DEBUG << "next atom: " << *atom << std::endl;
+    TraceSpan span(TraceEvent::STEP_BEGIN, atom.get());
+
+    AtomPtr focus = atom;
+    bool reducted = false;
+    ReductionFramePtr frame;
+    ReductionAtom const* reduction = dynamic_cast<ReductionAtom const*>(atom.get());
+    if (reduction) {
+        focus = reduction->focus;
+        reducted = reduction->reducted;
+        frame = reduction->frame;
+    }
+    auto push = [this](AtomPtr result) -> void {
+        LOG_DEBUG << "push atom: " << *result << std::endl;
+        this->add_atom(result);
+    };
+    AtomPtr result = interpret_expr_step(*kb, focus, reducted, frame, push);
+    if (result && frame) {
+        LOG_DEBUG << "sub expression is not interpretable" << std::endl;
+        push(reduct_next_arg(*frame, result));
+        return Atom::INVALID;
+    }
+    return result;
+}
+
+void GroundingSpace::serialize(std::ostream& out) const {
+    ::serialize(*content, out);
+}
+
+void GroundingSpace::deserialize(std::istream& in) {
+    add_atoms(::deserialize(in));
+}
+
+void GroundingSpace::count_atoms() {
+    atom_counts.fill(0);
+    for (auto const& atom : *content) {
+        ++atom_counts[atom->get_type()];
+    }
+}
+
+// Size of the string buffer allocated on heap, short strings are kept inside
+// of the string object
+static size_t heap_size(std::string const& str) {
+    char const* object = reinterpret_cast<char const*>(&str);
+    bool local = str.data() >= object && str.data() < object + sizeof(str);
+    return local ? 0 : str.capacity() + 1;
+}
+
+// Reference counters and deleter kept by shared_ptr together with the object
+static size_t const SHARED_PTR_CONTROL_SIZE = sizeof(void*) + 2 * sizeof(int);
+
+MemoryUsage GroundingSpace::get_memory_usage() const {
+    MemoryUsage usage{};
+    usage.index_bytes = content->capacity() * sizeof(AtomPtr);
+    std::unordered_map<Atom const*, size_t> references;
+    std::vector<Atom const*> stack;
+    for (auto const& atom : *content) {
+        stack.push_back(atom.get());
+    }
+    while (!stack.empty()) {
+        Atom const* atom = stack.back();
+        stack.pop_back();
+        ++usage.atoms[atom->get_type()];
+        size_t& count = references[atom];
+        if (++count > 1) {
+            usage.shared_atoms += count == 2;
+            continue;
+        }
+        ++usage.unique_atoms[atom->get_type()];
+        usage.atom_bytes += SHARED_PTR_CONTROL_SIZE;
+        switch (atom->get_type()) {
+            case Atom::SYMBOL:
+                usage.atom_bytes += sizeof(SymbolAtom);
+                usage.string_bytes += heap_size(static_cast<SymbolAtom const*>(atom)->get_symbol());
+                break;
+            case Atom::VARIABLE:
+                usage.atom_bytes += sizeof(VariableAtom);
+                usage.string_bytes += heap_size(static_cast<VariableAtom const*>(atom)->get_name());
+                break;
+            case Atom::EXPR: {
+                ExprAtom const* expr = static_cast<ExprAtom const*>(atom);
+                usage.atom_bytes += sizeof(ExprAtom);
+                usage.children_bytes += expr->get_children().capacity() * sizeof(AtomPtr);
+                for (auto const& child : expr->get_children()) {
+                    stack.push_back(child.get());
+                }
+                break;
+            }
+            case Atom::GROUNDED: {
+                GroundedAtom const* grounded = dynamic_cast<GroundedAtom const*>(atom);
+                usage.atom_bytes += grounded ? grounded->get_memory_size() : sizeof(Atom);
+                break;
+            }
+        }
+    }
+    return usage;
+}
+
+std::string GroundingSpace::to_string() const {
+    std::ostringstream out;
+    write_to(out);
+    return out.str();
+}
+
+void GroundingSpace::write_to(std::ostream& out) const {
+    out << '<';
+    ::write_to(out, *content, ", ");
+    out << '>';
+}
+
+void GroundingSpace::write_to_file(std::string const& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not open file " + path + " for writing");
+    }
+    write_to(out);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Could not write to file " + path);
+    }
 }
 
 bool GroundingSpace::operator==(SpaceAPI const& _other) const {
@@ -664,6 +1349,6 @@ bool GroundingSpace::operator==(SpaceAPI const& _other) const {
         return false;
     }
     GroundingSpace const& other = static_cast<GroundingSpace const&>(_other);
-    return content == other.content;
+    return *content == *other.content;
 }
 
@@ -1,13 +1,18 @@
 #ifndef GROUNDING_SPACE_H
 #define GROUNDING_SPACE_H
 
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
+#include <iosfwd>
 #include <stdexcept>
 #include <vector>
 #include <memory>
 #include <map>
 
 #include "SpaceAPI.h"
+#include "Metrics.h"
 
 // Atom
 
@@ -31,11 +36,17 @@ public:
     virtual bool operator==(Atom const& other) const = 0;
     virtual bool operator!=(Atom const& other) const { return !(*this == other); }
     virtual std::string to_string() const = 0;
+    // Writes text representation of the atom into the stream, default
+    // implementation writes result of to_string()
+    virtual void write_to(std::ostream& out) const;
 };
 
+std::ostream& operator<<(std::ostream& out, Atom const& atom);
+
 std::string to_string(Atom::Type type);
 bool operator==(std::vector<AtomPtr> const& a, std::vector<AtomPtr> const& b); 
 std::string to_string(std::vector<AtomPtr> const& atoms, std::string delimiter);
+void write_to(std::ostream& out, std::vector<AtomPtr> const& atoms, std::string const& delimiter);
 
 // Symbol atom
 
@@ -43,7 +54,7 @@ class SymbolAtom : public Atom {
 public:
     SymbolAtom(std::string symbol) : symbol(symbol) { }
     virtual ~SymbolAtom() { }
-    std::string get_symbol() const { return symbol; }
+    std::string const& get_symbol() const { return symbol; }
 
     Type get_type() const override { return SYMBOL; }
     bool operator==(Atom const& _other) const override { 
@@ -51,6 +62,7 @@ public:
         return other && symbol == other->symbol;
     }
     std::string to_string() const override { return symbol; }
+    void write_to(std::ostream& out) const override;
 private:
     std::string symbol;
 };
@@ -61,40 +73,16 @@ inline auto S(std::string symbol) {
     return std::make_shared<SymbolAtom>(symbol);
 }
 
-// Expression atom
-
-class ExprAtom : public Atom {
-public:
-    ExprAtom(std::initializer_list<AtomPtr> children) : children(children) { }
-    ExprAtom(std::vector<AtomPtr> children) : children(children) { }
-    virtual ~ExprAtom() { }
-    std::vector<AtomPtr>& get_children() { return children; }
-
-    Type get_type() const override { return EXPR; }
-    bool operator==(Atom const& _other) const override;
-    std::string to_string() const override { return "(" + ::to_string(children, " ") + ")"; }
-
-private:
-    std::vector<AtomPtr> children;
-};
-
-using ExprAtomPtr = std::shared_ptr<ExprAtom>;
-
-inline auto E(std::initializer_list<AtomPtr> children) {
-    return std::make_shared<ExprAtom>(children);
-}
-
-inline auto E(std::vector<AtomPtr> children) {
-    return std::make_shared<ExprAtom>(children);
-}
-
 // Variable atom
 
 class VariableAtom : public Atom {
 public:
-    VariableAtom(std::string name) : name(name) { }
+    VariableAtom(std::string name) : name(name),
+        mask(uint64_t(1) << (std::hash<std::string>()(this->name) % 64)) { }
     virtual ~VariableAtom() { }
-    std::string get_name() const { return name; }
+    std::string const& get_name() const { return name; }
+    // Bit which represents the name in ExprAtom::get_variable_mask()
+    uint64_t get_mask() const { return mask; }
 
     Type get_type() const override { return VARIABLE; }
     bool operator==(Atom const& _other) const override {
@@ -102,8 +90,10 @@ public:
         return other && name == other->name;
     }
     std::string to_string() const override { return "$" + name; }
+    void write_to(std::ostream& out) const override;
 private:
     std::string name;
+    uint64_t mask;
 };
 
 using VariableAtomPtr = std::shared_ptr<VariableAtom>;
@@ -119,6 +109,55 @@ public:
     }
 };
 
+// Expression atom
+
+// Expression is immutable after construction, so it can be shared between
+// other expressions, spaces and threads. Use with_child() to get a modified
+// copy.
+class ExprAtom : public Atom {
+public:
+    ExprAtom(std::initializer_list<AtomPtr> children) : children(children) {
+        collect_variable_mask();
+    }
+    ExprAtom(std::vector<AtomPtr> children) : children(std::move(children)) {
+        collect_variable_mask();
+    }
+    virtual ~ExprAtom();
+    std::vector<AtomPtr> const& get_children() const { return children; }
+    // Returns new expression with child at index replaced by atom, other
+    // children are shared with original expression
+    std::shared_ptr<ExprAtom> with_child(size_t index, AtomPtr atom) const;
+    // Variables of the expression and its subexpressions sorted by name,
+    // collected by traversing subexpressions which have variables
+    std::vector<VariableAtomPtr> get_variables() const;
+    bool has_variables() const { return variable_mask != 0; }
+    // Union of VariableAtom::get_mask() of the variables of the expression
+    // and its subexpressions, expression has no variables from the set
+    // when masks don't intersect
+    uint64_t get_variable_mask() const { return variable_mask; }
+
+    Type get_type() const override { return EXPR; }
+    bool operator==(Atom const& _other) const override;
+    std::string to_string() const override;
+    void write_to(std::ostream& out) const override;
+
+private:
+    void collect_variable_mask();
+
+    std::vector<AtomPtr> children;
+    uint64_t variable_mask;
+};
+
+using ExprAtomPtr = std::shared_ptr<ExprAtom>;
+
+inline auto E(std::initializer_list<AtomPtr> children) {
+    return std::make_shared<ExprAtom>(children);
+}
+
+inline auto E(std::vector<AtomPtr> children) {
+    return std::make_shared<ExprAtom>(std::move(children));
+}
+
 using Bindings = std::map<VariableAtomPtr, AtomPtr, LessVariableAtomPtr>;
 
 // Grounded atom
@@ -131,6 +170,8 @@ public:
     virtual void execute(GroundingSpace const& args, GroundingSpace& result) const {
         throw std::runtime_error("Operation is not supported");
     }
+    // Size of the atom object, it is used by memory accounting
+    virtual size_t get_memory_size() const { return sizeof(GroundedAtom); }
 
     Type get_type() const override { return GROUNDED; }
 };
@@ -148,6 +189,7 @@ public:
         return other && other->value == value;
     }
     T get() const { return value; }
+    size_t get_memory_size() const override { return sizeof(ValueAtom); }
 private:
     T value;
 };
@@ -163,31 +205,135 @@ struct Unification {
 using Unifications = std::vector<Unification>;
 
 struct UnificationResult {
+    // atom of the space which is unified with the query
+    AtomPtr candidate;
     // FIXME: a_bindings can be removed from here
     Bindings a_bindings;
     Bindings b_bindings;
     Unifications unifications;
 };
 
-class GroundingSpace : public SpaceAPI {
+// Space which can be queried by interpreter, see
+// GroundingSpace::interpret_step()
+class KnowledgeBase {
+public:
+    virtual ~KnowledgeBase() { }
+    virtual std::vector<Bindings> match(AtomPtr pattern) const = 0;
+    // occurs_check prevents binding variable to a value which contains the
+    // variable itself
+    virtual std::vector<UnificationResult> unify(AtomPtr atom, bool occurs_check = false) const = 0;
+};
+
+// Match and unify atom with each of candidates, spaces use them to
+// implement KnowledgeBase on top of atoms selected from their content
+std::vector<Bindings> match_candidates(std::vector<AtomPtr> const& candidates,
+        AtomPtr pattern);
+std::vector<UnificationResult> unify_candidates(std::vector<AtomPtr> const& candidates,
+        AtomPtr atom, bool occurs_check);
+
+// Matches pattern with candidates lazily, so caller can stop after the first
+// results without testing the rest of candidates. Iterator shares the
+// candidates vector, space which is changed during iteration copies its
+// content, so atoms added after the iterator is created are not matched.
+class MatchIterator {
+public:
+    MatchIterator(std::shared_ptr<std::vector<AtomPtr> const> candidates, AtomPtr pattern)
+        : candidates(std::move(candidates)), pattern(pattern), index(0) { }
+    // Returns false when there are no more matches
+    bool next(Bindings& bindings);
+
+private:
+    std::shared_ptr<std::vector<AtomPtr> const> candidates;
+    AtomPtr pattern;
+    size_t index;
+};
+
+// Memory used by the atoms of the space. Atoms shared between expressions
+// are counted once. Sizes are approximate: allocator overhead is not
+// counted and grounded atoms report the size of the object only.
+struct MemoryUsage {
+    // number of references to atoms by Atom::Type kept by the space and by
+    // distinct expressions
+    std::array<size_t, 4> atoms;
+    // number of distinct atom objects by Atom::Type
+    std::array<size_t, 4> unique_atoms;
+    // number of distinct atoms which are referenced more than once
+    size_t shared_atoms;
+    // atom objects and their reference counters
+    size_t atom_bytes;
+    // symbol and variable names allocated on heap
+    size_t string_bytes;
+    // children and variables vectors of expressions
+    size_t children_bytes;
+    // containers of the space which keep atoms
+    size_t index_bytes;
+
+    size_t get_total_bytes() const {
+        return atom_bytes + string_bytes + children_bytes + index_bytes;
+    }
+};
+
+// Content of the space is copied on write: copy of the space shares the
+// content vector with the original and the vector is copied only when one of
+// the spaces is changed while the vector is shared. So copy of the space is
+// a cheap snapshot which can be read by other thread while the original
+// space is changed.
+class GroundingSpace : public SpaceAPI, public KnowledgeBase {
 public:
 
     static std::string TYPE;
 
-    GroundingSpace() { }
-    GroundingSpace(std::initializer_list<AtomPtr> content) : content(content) { }
-    GroundingSpace(std::vector<AtomPtr> content) : content(content) { }
+    GroundingSpace() : content(std::make_shared<std::vector<AtomPtr>>()),
+        atom_counts(), counted(true) { }
+    GroundingSpace(std::initializer_list<AtomPtr> content)
+        : content(std::make_shared<std::vector<AtomPtr>>(content)), counted(true) {
+        count_atoms();
+    }
+    GroundingSpace(std::vector<AtomPtr> content)
+        : content(std::make_shared<std::vector<AtomPtr>>(std::move(content))), counted(true) {
+        count_atoms();
+    }
+    // Space for temporary atoms like results of grounded operations, atoms
+    // added into it are not counted by Metrics
+    static GroundingSpace scratch() {
+        GroundingSpace space;
+        space.counted = false;
+        return space;
+    }
 
     virtual ~GroundingSpace() { }
 
-    void add_native(const SpaceAPI* other) override {
-        throw std::logic_error("Method is not implemented");
-    }
+    // Adds atoms of other GroundingSpace, atoms are shared and not copied
+    void add_native(const SpaceAPI* other) override;
 
     std::string get_type() const override { return TYPE; }
 
     void add_atom(AtomPtr atom) {
-        content.push_back(atom);
+        if (counted) {
+            Metrics::add_atoms(1);
+        }
+        ++atom_counts[atom->get_type()];
+        own_content().push_back(atom);
+    }
+
+    void add_atoms(std::vector<AtomPtr> const& atoms) {
+        if (counted) {
+            Metrics::add_atoms(atoms.size());
+        }
+        for (auto const& atom : atoms) {
+            ++atom_counts[atom->get_type()];
+        }
+        std::vector<AtomPtr>& own = own_content();
+        own.insert(own.end(), atoms.begin(), atoms.end());
+    }
+
+    // Removes and returns the last atom, space should not be empty
+    AtomPtr pop_atom() {
+        std::vector<AtomPtr>& own = own_content();
+        AtomPtr atom = own.back();
+        own.pop_back();
+        --atom_counts[atom->get_type()];
+        return atom;
     }
 
     // TODO: Which operations should we add into SpaceAPI to make
@@ -197,20 +343,48 @@ public:
     // on a SpaceAPI level.
     AtomPtr interpret_step(SpaceAPI const& kb);
     // TODO: Discuss moving into SpaceAPI as match_to replacement
-    std::vector<Bindings> match(AtomPtr pattern) const;
+    std::vector<Bindings> match(AtomPtr pattern) const override;
     // FIXME: this method can be removed and implemented in client code on top
     // of GroundingSpace::match
     void match(SpaceAPI const& pattern, SpaceAPI const& templ, GroundingSpace& space) const;
-    std::vector<UnificationResult> unify(AtomPtr atom) const;
-    std::vector<AtomPtr> const& get_content() const { return content; }
+    MatchIterator match_iterator(AtomPtr pattern) const { return MatchIterator(content, pattern); }
+    std::vector<UnificationResult> unify(AtomPtr atom, bool occurs_check = false) const override;
+    std::vector<AtomPtr> const& get_content() const { return *content; }
+
+    // Number of atoms of the given type in the space, subexpressions are not
+    // counted. Counters are updated on each change of the space.
+    size_t get_atom_count(Atom::Type type) const { return atom_counts[type]; }
+    // Walks all atoms of the space including subexpressions to calculate
+    // exact memory usage
+    MemoryUsage get_memory_usage() const;
+
+    // Writes content in binary format, see Serialization.h
+    void serialize(std::ostream& out) const;
+    // Reads atoms written by serialize() and adds them to the content
+    void deserialize(std::istream& in);
 
     bool operator==(SpaceAPI const& space) const;
     bool operator!=(SpaceAPI const& other) const { return !(*this == other); }
-    std::string to_string() const { return "<" + ::to_string(content, ", ") + ">"; }
+    std::string to_string() const;
+    // Writes text representation of the space into the stream, it doesn't
+    // build intermediate strings so it is suitable for large spaces
+    void write_to(std::ostream& out) const;
+    void write_to_file(std::string const& path) const;
 
 private:
 
-    std::vector<AtomPtr> content;
+    void count_atoms();
+    // Copies the content when it is shared with other spaces or iterators
+    std::vector<AtomPtr>& own_content() {
+        if (content.use_count() != 1) {
+            content = std::make_shared<std::vector<AtomPtr>>(*content);
+        }
+        return *content;
+    }
+
+    std::shared_ptr<std::vector<AtomPtr>> content;
+    std::array<size_t, 4> atom_counts;
+    bool counted;
 };
 
 // TODO: think how to export it properly: either we should export API to
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#include "ImageSpace.h"
+#include "MappedFile.h"
+#include "Serialization.h"
+
+// Image space
+
+std::string ImageSpace::TYPE = "ImageSpace";
+
+static char const IMAGE_MAGIC[] = { 'H', 'Y', 'P', 'I' };
+static uint32_t const IMAGE_BYTE_ORDER = 0x01020304;
+static uint64_t const IMAGE_VERSION = 1;
+
+// Header and index sections are used in place, so they are written in the
+// host format and image can be used only on hosts with the same byte order
+struct ImageHeader {
+    char magic[4];
+    uint32_t byte_order;
+    uint64_t version;
+    uint64_t count;
+    // atoms in binary format
+    uint64_t atoms_offset;
+    uint64_t atoms_size;
+    // offsets of the atoms inside of binary format body
+    uint64_t offsets_offset;
+    // indexes of atoms which are not expressions with symbol head
+    uint64_t unindexed_offset;
+    uint64_t unindexed_size;
+    // entries sorted by key, key is a size of the expression
+    uint64_t by_size_offset;
+    uint64_t by_size_size;
+    // key is a hash of the expression head and size
+    uint64_t by_head_offset;
+    uint64_t by_head_size;
+    // key is a hash of the head and the first argument
+    uint64_t by_arg_offset;
+    uint64_t by_arg_size;
+    // key is a hash of the head and the kind of the first argument
+    uint64_t by_kind_offset;
+    uint64_t by_kind_size;
+};
+
+struct ImageIndexEntry {
+    uint64_t key;
+    uint64_t index;
+};
+
+static bool operator<(ImageIndexEntry const& a, ImageIndexEntry const& b) {
+    return a.key < b.key || (a.key == b.key && a.index < b.index);
+}
+
+// Index keys are FNV-1a hashes, collisions only add candidates which are
+// filtered out by match and unify later
+static uint64_t const FNV_OFFSET = 14695981039346656037ULL;
+static uint64_t const FNV_PRIME = 1099511628211ULL;
+
+static uint64_t hash_bytes(uint64_t hash, char const* bytes, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(bytes[i])) * FNV_PRIME;
+    }
+    // separator, so concatenated parts don't collide with each other
+    return (hash ^ 0xff) * FNV_PRIME;
+}
+
+static uint64_t hash_string(uint64_t hash, std::string const& str) {
+    return hash_bytes(hash, str.data(), str.size());
+}
+
+static uint64_t hash_int(uint64_t hash, uint64_t value) {
+    return hash_bytes(hash, reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+// Candidate and query expressions of the same size with different symbol
+// heads never match or unify. Expressions of different sizes never match,
+// but they are unified (returned in UnificationResult::unifications). First
+// arguments which are symbols never match or unify when
+// symbols are different; first arguments which are expressions with symbol
+// heads never match or unify when heads or sizes are different. Unify also
+// allows symbol argument to be unified with expression argument (such pairs
+// are returned in UnificationResult::unifications).
+enum ArgKind {
+    SYMBOL_ARG,
+    EXPR_ARG,
+    OTHER_ARG
+};
+
+struct AtomKey {
+    bool indexed;
+    uint64_t size;
+    uint64_t head;
+    ArgKind kind;
+    uint64_t arg;
+};
+
+static AtomKey get_atom_key(AtomPtr const& atom) {
+    AtomKey key{ false, 0, 0, OTHER_ARG, 0 };
+    if (atom->get_type() != Atom::EXPR) {
+        return key;
+    }
+    auto const& children = static_cast<ExprAtom const&>(*atom).get_children();
+    if (children.empty() || children[0]->get_type() != Atom::SYMBOL) {
+        return key;
+    }
+    key.indexed = true;
+    key.size = children.size();
+    key.head = hash_int(hash_string(FNV_OFFSET,
+            static_cast<SymbolAtom const&>(*children[0]).get_symbol()), key.size);
+    if (children.size() < 2) {
+        return key;
+    }
+    AtomPtr const& arg = children[1];
+    if (arg->get_type() == Atom::SYMBOL) {
+        key.kind = SYMBOL_ARG;
+        key.arg = hash_string(hash_int(key.head, SYMBOL_ARG),
+                static_cast<SymbolAtom const&>(*arg).get_symbol());
+    } else if (arg->get_type() == Atom::EXPR) {
+        auto const& arg_children = static_cast<ExprAtom const&>(*arg).get_children();
+        if (!arg_children.empty() && arg_children[0]->get_type() == Atom::SYMBOL) {
+            key.kind = EXPR_ARG;
+            key.arg = hash_int(hash_string(hash_int(key.head, EXPR_ARG),
+                    static_cast<SymbolAtom const&>(*arg_children[0]).get_symbol()),
+                    arg_children.size());
+        }
+    }
+    return key;
+}
+
+static uint64_t get_kind_key(uint64_t head, ArgKind kind) {
+    return hash_int(head, kind);
+}
+
+static uint64_t align(uint64_t offset) {
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+template<typename T>
+static void write_section(std::ostream& out, uint64_t& offset, T const* data, size_t size) {
+    out.write(reinterpret_cast<char const*>(data), size * sizeof(T));
+    uint64_t end = offset + size * sizeof(T);
+    offset = align(end);
+    static char const padding[8] = { 0 };
+    out.write(padding, offset - end);
+}
+
+void ImageSpace::write(std::vector<AtomPtr> const& atoms, std::ostream& out) {
+    AtomEncoder encoder;
+    std::vector<uint64_t> offsets;
+    std::vector<uint64_t> unindexed;
+    std::vector<ImageIndexEntry> by_size;
+    std::vector<ImageIndexEntry> by_head;
+    std::vector<ImageIndexEntry> by_arg;
+    std::vector<ImageIndexEntry> by_kind;
+    offsets.reserve(atoms.size());
+    for (uint64_t index = 0; index < atoms.size(); ++index) {
+        AtomPtr const& atom = atoms[index];
+        offsets.push_back(encoder.get_body_size());
+        encoder.encode(atom);
+        AtomKey key = get_atom_key(atom);
+        if (!key.indexed) {
+            unindexed.push_back(index);
+            continue;
+        }
+        by_size.push_back({ key.size, index });
+        by_head.push_back({ key.head, index });
+        by_kind.push_back({ get_kind_key(key.head, key.kind), index });
+        if (key.kind != OTHER_ARG) {
+            by_arg.push_back({ key.arg, index });
+        }
+    }
+    std::sort(by_size.begin(), by_size.end());
+    std::sort(by_head.begin(), by_head.end());
+    std::sort(by_arg.begin(), by_arg.end());
+    std::sort(by_kind.begin(), by_kind.end());
+    std::ostringstream binary;
+    encoder.write(binary);
+    std::string data = binary.str();
+
+    ImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.byte_order = IMAGE_BYTE_ORDER;
+    header.version = IMAGE_VERSION;
+    header.count = atoms.size();
+    uint64_t offset = align(sizeof(ImageHeader));
+    header.atoms_offset = offset;
+    header.atoms_size = data.size();
+    offset = align(offset + data.size());
+    header.offsets_offset = offset;
+    offset = align(offset + offsets.size() * sizeof(uint64_t));
+    header.unindexed_offset = offset;
+    header.unindexed_size = unindexed.size();
+    offset = align(offset + unindexed.size() * sizeof(uint64_t));
+    header.by_size_offset = offset;
+    header.by_size_size = by_size.size();
+    offset = align(offset + by_size.size() * sizeof(ImageIndexEntry));
+    header.by_head_offset = offset;
+    header.by_head_size = by_head.size();
+    offset = align(offset + by_head.size() * sizeof(ImageIndexEntry));
+    header.by_arg_offset = offset;
+    header.by_arg_size = by_arg.size();
+    offset = align(offset + by_arg.size() * sizeof(ImageIndexEntry));
+    header.by_kind_offset = offset;
+    header.by_kind_size = by_kind.size();
+
+    offset = 0;
+    write_section(out, offset, &header, 1);
+    write_section(out, offset, data.data(), data.size());
+    write_section(out, offset, offsets.data(), offsets.size());
+    write_section(out, offset, unindexed.data(), unindexed.size());
+    write_section(out, offset, by_size.data(), by_size.size());
+    write_section(out, offset, by_head.data(), by_head.size());
+    write_section(out, offset, by_arg.data(), by_arg.size());
+    write_section(out, offset, by_kind.data(), by_kind.size());
+}
+
+ImageSpace::ImageSpace(std::string path) : file(new MappedFile(path, MappedFile::RANDOM)) {
+    char const* begin = file->begin();
+    uint64_t size = file->end() - begin;
+    if (size < sizeof(ImageHeader)) {
+        throw std::runtime_error("File is not a space image: " + path);
+    }
+    header = reinterpret_cast<ImageHeader const*>(begin);
+    if (std::memcmp(header->magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC))) {
+        throw std::runtime_error("File is not a space image: " + path);
+    }
+    if (header->byte_order != IMAGE_BYTE_ORDER) {
+        throw std::runtime_error("Space image has different byte order: " + path);
+    }
+    if (header->version != IMAGE_VERSION) {
+        throw std::runtime_error("Unsupported space image version: " +
+                std::to_string(header->version));
+    }
+    auto check_section = [&](uint64_t offset, uint64_t count, uint64_t item_size) -> void {
+        if (offset % 8 || offset > size || count > (size - offset) / item_size) {
+            throw std::runtime_error("Space image is corrupted: " + path);
+        }
+    };
+    check_section(header->atoms_offset, header->atoms_size, 1);
+    check_section(header->offsets_offset, header->count, sizeof(uint64_t));
+    check_section(header->unindexed_offset, header->unindexed_size, sizeof(uint64_t));
+    check_section(header->by_size_offset, header->by_size_size, sizeof(ImageIndexEntry));
+    check_section(header->by_head_offset, header->by_head_size, sizeof(ImageIndexEntry));
+    check_section(header->by_arg_offset, header->by_arg_size, sizeof(ImageIndexEntry));
+    check_section(header->by_kind_offset, header->by_kind_size, sizeof(ImageIndexEntry));
+    offsets = reinterpret_cast<uint64_t const*>(begin + header->offsets_offset);
+    char const* atoms_begin = begin + header->atoms_offset;
+    decoder.reset(new AtomDecoder(atoms_begin, atoms_begin + header->atoms_size));
+    if (decoder->get_count() != header->count) {
+        throw std::runtime_error("Space image is corrupted: " + path);
+    }
+    atoms.resize(header->count);
+}
+
+ImageSpace::~ImageSpace() { }
+
+size_t ImageSpace::size() const {
+    return header->count;
+}
+
+AtomPtr ImageSpace::get_atom(size_t index) const {
+    if (index >= atoms.size()) {
+        throw std::out_of_range("Atom index is out of range: " + std::to_string(index));
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return get_cached_atom(index);
+}
+
+AtomPtr const& ImageSpace::get_cached_atom(size_t index) const {
+    if (!atoms[index]) {
+        atoms[index] = decoder->decode_at(offsets[index]);
+    }
+    return atoms[index];
+}
+
+void ImageSpace::read_atoms(AtomSink const& sink) const {
+    for (size_t i = 0; i < atoms.size(); ++i) {
+        AtomPtr atom;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            atom = atoms[i] ? atoms[i] : decoder->decode_at(offsets[i]);
+        }
+        sink(atom);
+    }
+}
+
+static struct RegisterImageSpaceConverters {
+    RegisterImageSpaceConverters() {
+        register_atom_source<ImageSpace>(
+                [](ImageSpace const& image, AtomSink const& sink) -> void {
+                    image.read_atoms(sink);
+                });
+    }
+} register_image_space_converters;
+
+void ImageSpace::add_entries(std::vector<size_t>& indexes, uint64_t offset,
+        uint64_t size, uint64_t key) const {
+    ImageIndexEntry const* begin = reinterpret_cast<ImageIndexEntry const*>(file->begin() + offset);
+    ImageIndexEntry const* end = begin + size;
+    ImageIndexEntry const* it = std::lower_bound(begin, end, ImageIndexEntry{ key, 0 });
+    for (; it != end && it->key == key; ++it) {
+        indexes.push_back(it->index);
+    }
+}
+
+void ImageSpace::add_entries(std::vector<size_t>& indexes, ImageIndexEntry const* begin,
+        ImageIndexEntry const* end) const {
+    for (ImageIndexEntry const* it = begin; it != end; ++it) {
+        indexes.push_back(it->index);
+    }
+}
+
+// Candidates are returned in the order of atoms in the image, the same way
+// GroundingSpace returns results in the order of its content
+std::vector<AtomPtr> ImageSpace::get_candidates(AtomPtr const& atom, bool unify) const {
+    AtomKey key = get_atom_key(atom);
+    std::vector<AtomPtr> candidates;
+    if (!key.indexed) {
+        candidates.reserve(atoms.size());
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < atoms.size(); ++i) {
+            candidates.push_back(get_cached_atom(i));
+        }
+        return candidates;
+    }
+    uint64_t const* unindexed = reinterpret_cast<uint64_t const*>(file->begin() + header->unindexed_offset);
+    std::vector<size_t> indexes(unindexed, unindexed + header->unindexed_size);
+    if (unify) {
+        // entries of other sizes are the ones before and after the range of
+        // the query size
+        ImageIndexEntry const* begin = reinterpret_cast<ImageIndexEntry const*>(
+                file->begin() + header->by_size_offset);
+        ImageIndexEntry const* end = begin + header->by_size_size;
+        ImageIndexEntry const* lower = std::lower_bound(begin, end,
+                ImageIndexEntry{ key.size, 0 });
+        ImageIndexEntry const* upper = std::lower_bound(lower, end,
+                ImageIndexEntry{ key.size + 1, 0 });
+        add_entries(indexes, begin, lower);
+        add_entries(indexes, upper, end);
+    }
+    if (key.kind == OTHER_ARG) {
+        add_entries(indexes, header->by_head_offset, header->by_head_size, key.head);
+    } else {
+        add_entries(indexes, header->by_arg_offset, header->by_arg_size, key.arg);
+        add_entries(indexes, header->by_kind_offset, header->by_kind_size,
+                get_kind_key(key.head, OTHER_ARG));
+        if (unify) {
+            ArgKind other = key.kind == SYMBOL_ARG ? EXPR_ARG : SYMBOL_ARG;
+            add_entries(indexes, header->by_kind_offset, header->by_kind_size,
+                    get_kind_key(key.head, other));
+        }
+    }
+    std::sort(indexes.begin(), indexes.end());
+    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+    candidates.reserve(indexes.size());
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t index : indexes) {
+        candidates.push_back(get_cached_atom(index));
+    }
+    return candidates;
+}
+
+std::vector<Bindings> ImageSpace::match(AtomPtr pattern) const {
+    return match_candidates(get_candidates(pattern, false), pattern);
+}
+
+std::vector<UnificationResult> ImageSpace::unify(AtomPtr atom, bool occurs_check) const {
+    return unify_candidates(get_candidates(atom, true), atom, occurs_check);
+}
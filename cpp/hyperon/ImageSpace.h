@@ -0,0 +1,72 @@
+#ifndef IMAGE_SPACE_H
+#define IMAGE_SPACE_H
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "SpaceAPI.h"
+#include "GroundingSpace.h"
+
+class MappedFile;
+class AtomDecoder;
+struct ImageHeader;
+struct ImageIndexEntry;
+
+// Image space
+
+// Read-only space backed by memory mapped image file. Image contains atoms
+// in binary format (see Serialization.h), offsets of the atoms and indexes
+// which are used to select candidates for match and unify queries. Indexes
+// are used in place, atoms are decoded on first access only, so processes
+// which open the same image share the page cache and start fast. Decoded
+// atoms are cached, the cache and the decoder are guarded by the mutex, so
+// space can be queried from many threads.
+class ImageSpace : public SpaceAPI, public KnowledgeBase {
+public:
+
+    static std::string TYPE;
+
+    // Writes atoms into the image which can be opened by ImageSpace
+    static void write(std::vector<AtomPtr> const& atoms, std::ostream& out);
+
+    ImageSpace(std::string path);
+    virtual ~ImageSpace();
+
+    void add_native(const SpaceAPI* other) override {
+        throw std::logic_error(TYPE + " is read-only");
+    }
+
+    std::string get_type() const override { return TYPE; }
+
+    size_t size() const;
+    AtomPtr get_atom(size_t index) const;
+    // Passes all atoms of the image into sink, unlike get_atom() decoded
+    // atoms are not cached to not keep the whole image in memory. It is
+    // used by SpaceAPI::add_to() to add the image to other spaces.
+    void read_atoms(AtomSink const& sink) const;
+
+    std::vector<Bindings> match(AtomPtr pattern) const override;
+    std::vector<UnificationResult> unify(AtomPtr atom, bool occurs_check = false) const override;
+
+private:
+
+    // Should be called with the mutex locked
+    AtomPtr const& get_cached_atom(size_t index) const;
+    std::vector<AtomPtr> get_candidates(AtomPtr const& atom, bool unify) const;
+    void add_entries(std::vector<size_t>& indexes, uint64_t offset,
+            uint64_t size, uint64_t key) const;
+    void add_entries(std::vector<size_t>& indexes, ImageIndexEntry const* begin,
+            ImageIndexEntry const* end) const;
+
+    std::unique_ptr<MappedFile> file;
+    ImageHeader const* header;
+    uint64_t const* offsets;
+    mutable std::mutex mutex;
+    std::unique_ptr<AtomDecoder> decoder;
+    mutable std::vector<AtomPtr> atoms;
+};
+
+#endif /* IMAGE_SPACE_H */
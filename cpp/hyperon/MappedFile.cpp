@@ -0,0 +1,41 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(std::string const& path, Access access) : data(nullptr), size(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        throw std::runtime_error("Could not open file " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == -1) {
+        int error = errno;
+        ::close(fd);
+        throw std::runtime_error("Could not get size of file " + path + ": " + std::strerror(error));
+    }
+    size = st.st_size;
+    if (size > 0) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("Could not map file " + path + ": " + std::strerror(error));
+        }
+        ::madvise(mapped, size, access == SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+        data = static_cast<char const*>(mapped);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+
+// Read-only memory mapping of the whole file, pages are loaded by OS on
+// demand and are shared with other processes which map the same file
+class MappedFile {
+public:
+    enum Access {
+        SEQUENTIAL,
+        RANDOM
+    };
+
+    MappedFile(std::string const& path, Access access);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    char const* begin() const { return data; }
+    char const* end() const { return data + size; }
+
+private:
+    char const* data;
+    size_t size;
+};
+
+#endif /* MAPPED_FILE_H */
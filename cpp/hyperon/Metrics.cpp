@@ -0,0 +1,195 @@
+#include <mutex>
+#include <vector>
+
+#include "Metrics.h"
+
+// Counters are written by the owning thread only, so plain load and store
+// are enough, atomics make concurrent reads safe
+using Counter = std::atomic<uint64_t>;
+
+static void add(Counter& counter, uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+            std::memory_order_relaxed);
+}
+
+struct OperationCounters {
+    Counter calls;
+    Counter total_time;
+    std::array<Counter, OperationMetrics::BUCKETS> latency;
+};
+
+struct ThreadMetrics {
+    std::array<OperationCounters, MetricsSnapshot::OPERATIONS> operations;
+    Counter candidates_examined;
+    Counter candidates_matched;
+    Counter atoms_added;
+
+    ThreadMetrics();
+    ~ThreadMetrics();
+
+    void init() {
+        for (auto& operation : operations) {
+            operation.calls.store(0, std::memory_order_relaxed);
+            operation.total_time.store(0, std::memory_order_relaxed);
+            for (auto& bucket : operation.latency) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+        candidates_examined.store(0, std::memory_order_relaxed);
+        candidates_matched.store(0, std::memory_order_relaxed);
+        atoms_added.store(0, std::memory_order_relaxed);
+    }
+
+    void add_to(MetricsSnapshot& snapshot) const {
+        for (size_t i = 0; i < operations.size(); ++i) {
+            OperationCounters const& counters = operations[i];
+            OperationMetrics& metrics = snapshot.operations[i];
+            metrics.calls += counters.calls.load(std::memory_order_relaxed);
+            metrics.total_time += counters.total_time.load(std::memory_order_relaxed);
+            for (size_t j = 0; j < counters.latency.size(); ++j) {
+                metrics.latency[j] += counters.latency[j].load(std::memory_order_relaxed);
+            }
+        }
+        snapshot.candidates_examined += candidates_examined.load(std::memory_order_relaxed);
+        snapshot.candidates_matched += candidates_matched.load(std::memory_order_relaxed);
+        snapshot.atoms_added += atoms_added.load(std::memory_order_relaxed);
+    }
+};
+
+// Keeps counters of running threads and sum of counters of finished threads
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance() {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    void add(ThreadMetrics* metrics) {
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.push_back(metrics);
+    }
+
+    void remove(ThreadMetrics* metrics) {
+        std::lock_guard<std::mutex> lock(mutex);
+        metrics->add_to(finished);
+        for (auto it = threads.begin(); it != threads.end(); ++it) {
+            if (*it == metrics) {
+                threads.erase(it);
+                break;
+            }
+        }
+    }
+
+    MetricsSnapshot get_snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        MetricsSnapshot snapshot = get_total();
+        subtract(snapshot, baseline);
+        return snapshot;
+    }
+
+    // Counters are owned by threads, so instead of resetting them current
+    // values are remembered and subtracted from the following snapshots
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        baseline = get_total();
+    }
+
+private:
+    MetricsRegistry() : finished(), baseline() { }
+
+    MetricsSnapshot get_total() const {
+        MetricsSnapshot snapshot = finished;
+        for (auto const* metrics : threads) {
+            metrics->add_to(snapshot);
+        }
+        return snapshot;
+    }
+
+    static void subtract(MetricsSnapshot& snapshot, MetricsSnapshot const& other) {
+        for (size_t i = 0; i < snapshot.operations.size(); ++i) {
+            OperationMetrics& metrics = snapshot.operations[i];
+            OperationMetrics const& other_metrics = other.operations[i];
+            metrics.calls -= other_metrics.calls;
+            metrics.total_time -= other_metrics.total_time;
+            for (size_t j = 0; j < metrics.latency.size(); ++j) {
+                metrics.latency[j] -= other_metrics.latency[j];
+            }
+        }
+        snapshot.candidates_examined -= other.candidates_examined;
+        snapshot.candidates_matched -= other.candidates_matched;
+        snapshot.atoms_added -= other.atoms_added;
+    }
+
+    std::mutex mutex;
+    std::vector<ThreadMetrics*> threads;
+    MetricsSnapshot finished;
+    MetricsSnapshot baseline;
+};
+
+ThreadMetrics::ThreadMetrics() {
+    init();
+    MetricsRegistry::instance().add(this);
+}
+
+ThreadMetrics::~ThreadMetrics() {
+    MetricsRegistry::instance().remove(this);
+}
+
+static thread_local ThreadMetrics thread_metrics;
+
+static size_t latency_bucket(uint64_t time) {
+    size_t bucket = 0;
+    while (time && bucket < OperationMetrics::BUCKETS - 1) {
+        time >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+uint64_t OperationMetrics::get_percentile(double p) const {
+    uint64_t timed = 0;
+    for (auto count : latency) {
+        timed += count;
+    }
+    if (timed == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(p * timed);
+    uint64_t count = 0;
+    for (size_t i = 0; i < latency.size(); ++i) {
+        count += latency[i];
+        if (count > rank || count == timed) {
+            return i == 0 ? 0 : (uint64_t(1) << i) - 1;
+        }
+    }
+    return 0;
+}
+
+void Metrics::add_call(Operation operation) {
+    add(thread_metrics.operations[operation].calls, 1);
+}
+
+void Metrics::add_call(Operation operation, uint64_t time) {
+    OperationCounters& counters = thread_metrics.operations[operation];
+    add(counters.calls, 1);
+    add(counters.total_time, time);
+    add(counters.latency[latency_bucket(time)], 1);
+}
+
+void Metrics::add_candidates(uint64_t examined, uint64_t matched) {
+    add(thread_metrics.candidates_examined, examined);
+    add(thread_metrics.candidates_matched, matched);
+}
+
+void Metrics::add_atoms(uint64_t count) {
+    add(thread_metrics.operations[Operation::ADD_ATOM].calls, 1);
+    add(thread_metrics.atoms_added, count);
+}
+
+MetricsSnapshot Metrics::get_snapshot() {
+    return MetricsRegistry::instance().get_snapshot();
+}
+
+void Metrics::reset() {
+    MetricsRegistry::instance().reset();
+}
@@ -0,0 +1,81 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Metrics
+
+// Always-on counters of the space operations. Each thread updates its own
+// counters without synchronization, counters of all threads are summed when
+// snapshot is taken. Latencies are collected into histograms with buckets of
+// power of two nanoseconds: bucket 0 counts zero latencies and bucket i
+// counts latencies in [2^(i-1), 2^i) ns. add_atom() and add_atoms() calls
+// are counted with the number of added atoms but not timed because timer
+// costs more than the operation itself.
+
+struct OperationMetrics {
+    static size_t const BUCKETS = 48;
+
+    uint64_t calls;
+    // nanoseconds
+    uint64_t total_time;
+    std::array<uint64_t, BUCKETS> latency;
+
+    // Upper bound of the bucket which contains the percentile, p is in
+    // [0, 1] range, returns 0 when there are no timed calls
+    uint64_t get_percentile(double p) const;
+};
+
+struct MetricsSnapshot {
+    enum Operation {
+        MATCH,
+        UNIFY,
+        ADD_ATOM,
+        INTERPRET_STEP
+    };
+    static size_t const OPERATIONS = 4;
+
+    std::array<OperationMetrics, OPERATIONS> operations;
+    // candidates tested by match and unify
+    uint64_t candidates_examined;
+    // candidates successfully matched or unified
+    uint64_t candidates_matched;
+    // atoms added by ADD_ATOM calls
+    uint64_t atoms_added;
+};
+
+class Metrics {
+public:
+    using Operation = MetricsSnapshot::Operation;
+
+    static void add_call(Operation operation);
+    static void add_call(Operation operation, uint64_t time);
+    static void add_candidates(uint64_t examined, uint64_t matched);
+    // Counts single ADD_ATOM call which adds count atoms
+    static void add_atoms(uint64_t count);
+
+    static MetricsSnapshot get_snapshot();
+    static void reset();
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Measures time from construction to destruction
+class MetricsTimer {
+public:
+    MetricsTimer(Metrics::Operation operation)
+        : operation(operation), start(Metrics::now()) { }
+    ~MetricsTimer() { Metrics::add_call(operation, Metrics::now() - start); }
+
+private:
+    Metrics::Operation operation;
+    uint64_t start;
+};
+
+#endif /* METRICS_H */
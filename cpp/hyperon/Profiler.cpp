@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+#include "Profiler.h"
+
+std::atomic<bool> Profiler::enabled(false);
+
+class Profile {
+public:
+    static Profile& instance() {
+        static Profile profile;
+        return profile;
+    }
+
+    std::mutex mutex;
+    std::unordered_map<Atom const*, RuleProfile> rules;
+    std::unordered_map<Atom const*, GroundedProfile> grounded;
+
+    RuleProfile& get_rule(AtomPtr const& rule) {
+        RuleProfile& profile = rules[rule.get()];
+        if (!profile.rule) {
+            profile = { rule, 0, 0, 0, 0 };
+        }
+        return profile;
+    }
+};
+
+template<typename T>
+static std::vector<T> sorted_by_time(std::unordered_map<Atom const*, T> const& profiles) {
+    std::vector<T> sorted;
+    sorted.reserve(profiles.size());
+    for (auto const& pair : profiles) {
+        sorted.push_back(pair.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](T const& a, T const& b) -> bool {
+                return a.time > b.time;
+            });
+    return sorted;
+}
+
+void Profiler::clear() {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    profile.rules.clear();
+    profile.grounded.clear();
+}
+
+std::vector<RuleProfile> Profiler::get_rules() {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    return sorted_by_time(profile.rules);
+}
+
+std::vector<GroundedProfile> Profiler::get_grounded() {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    return sorted_by_time(profile.grounded);
+}
+
+static void write_time(std::ostream& out, uint64_t time) {
+    out << std::setw(12) << time / 1000 << '.' << std::setw(3) <<
+        std::setfill('0') << time % 1000 << std::setfill(' ');
+}
+
+void Profiler::write_report(std::ostream& out) {
+    out << "rules:\n" << std::setw(10) << "tests" << std::setw(14) << "unifications" <<
+        std::setw(10) << "results" << std::setw(16) << "time, us" << "  rule\n";
+    for (auto const& rule : get_rules()) {
+        out << std::setw(10) << rule.tests << std::setw(14) << rule.unifications <<
+            std::setw(10) << rule.results;
+        write_time(out, rule.time);
+        out << "  " << *rule.rule << '\n';
+    }
+    out << "grounded atoms:\n" << std::setw(10) << "calls" << std::setw(14) << "exceptions" <<
+        std::setw(10) << "results" << std::setw(16) << "time, us" << "  atom\n";
+    for (auto const& grounded : get_grounded()) {
+        out << std::setw(10) << grounded.calls << std::setw(14) << grounded.exceptions <<
+            std::setw(10) << grounded.results;
+        write_time(out, grounded.time);
+        out << "  " << *grounded.atom << '\n';
+    }
+}
+
+std::string Profiler::get_report() {
+    std::ostringstream out;
+    write_report(out);
+    return out.str();
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::add_rule_tests(std::vector<RuleTest> const& tests) {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    for (auto const& test : tests) {
+        RuleProfile& rule = profile.get_rule(*test.rule);
+        ++rule.tests;
+        rule.unifications += test.unified;
+        rule.time += test.time;
+    }
+}
+
+void Profiler::add_rule_results(std::vector<UnificationResult> const& results) {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    for (auto const& result : results) {
+        if (result.candidate) {
+            ++profile.get_rule(result.candidate).results;
+        }
+    }
+}
+
+void Profiler::add_grounded_call(AtomPtr const& atom, bool exception,
+        uint64_t results, uint64_t time) {
+    Profile& profile = Profile::instance();
+    std::lock_guard<std::mutex> lock(profile.mutex);
+    GroundedProfile& grounded = profile.grounded[atom.get()];
+    if (!grounded.atom) {
+        grounded = { atom, 0, 0, 0, 0 };
+    }
+    ++grounded.calls;
+    grounded.exceptions += exception;
+    grounded.results += results;
+    grounded.time += time;
+}
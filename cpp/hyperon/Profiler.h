@@ -0,0 +1,77 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "GroundingSpace.h"
+
+// Profiler
+
+// Collects statistics of the knowledge base rules and grounded atoms used by
+// the interpreter. Candidate tests are counted by match and unify for each
+// atom of the space, so statistics of the rule is collected for any atom
+// of the knowledge base. Time is measured in nanoseconds. Profiler is
+// disabled by default and costs a single atomic load per query when
+// disabled. Statistics is collected from all threads.
+
+struct RuleProfile {
+    AtomPtr rule;
+    // number of times the rule was unified with a query
+    uint64_t tests;
+    // number of successful unifications
+    uint64_t unifications;
+    // number of atoms produced by the interpreter using the rule
+    uint64_t results;
+    // time spent in unification of the rule
+    uint64_t time;
+};
+
+struct GroundedProfile {
+    AtomPtr atom;
+    uint64_t calls;
+    uint64_t exceptions;
+    uint64_t results;
+    // cumulative time of the GroundedAtom::execute() calls
+    uint64_t time;
+};
+
+class Profiler {
+public:
+
+    static void enable() { enabled.store(true, std::memory_order_relaxed); }
+    static void disable() { enabled.store(false, std::memory_order_relaxed); }
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+    static void clear();
+
+    // Statistics sorted by time in descending order
+    static std::vector<RuleProfile> get_rules();
+    static std::vector<GroundedProfile> get_grounded();
+
+    // Writes human readable table of rules and grounded atoms
+    static void write_report(std::ostream& out);
+    static std::string get_report();
+
+    // Methods below are used by spaces and interpreter to report statistics
+
+    struct RuleTest {
+        AtomPtr const* rule;
+        bool unified;
+        uint64_t time;
+    };
+
+    static uint64_t now();
+    static void add_rule_tests(std::vector<RuleTest> const& tests);
+    static void add_rule_results(std::vector<UnificationResult> const& results);
+    static void add_grounded_call(AtomPtr const& atom, bool exception,
+            uint64_t results, uint64_t time);
+
+private:
+
+    static std::atomic<bool> enabled;
+};
+
+#endif /* PROFILER_H */
@@ -0,0 +1,309 @@
+#include "Serialization.h"
+
+// Serialization
+
+static char const MAGIC[] = { 'H', 'Y', 'P', 'A' };
+static uint64_t const VERSION = 1;
+
+enum Tag : uint8_t {
+    SYMBOL_TAG,
+    VARIABLE_TAG,
+    EXPR_TAG,
+    GROUNDED_TAG
+};
+
+struct GroundedCodec {
+    std::string name;
+    GroundedEncoder encoder;
+    GroundedDecoder decoder;
+};
+
+class GroundedCodecRegistry {
+public:
+    static GroundedCodecRegistry& instance() {
+        static GroundedCodecRegistry registry;
+        return registry;
+    }
+
+    void add(GroundedCodec codec, std::type_index const* type, Atom const* atom) {
+        if (by_name.count(codec.name)) {
+            throw std::logic_error("Grounded codec is registered already: " + codec.name);
+        }
+        GroundedCodec const* added = &(by_name[codec.name] = codec);
+        if (type) {
+            by_type.emplace(*type, added);
+        }
+        if (atom) {
+            by_atom.emplace(atom, added);
+        }
+    }
+
+    GroundedCodec const* find(Atom const& atom) const {
+        auto singleton = by_atom.find(&atom);
+        if (singleton != by_atom.end()) {
+            return singleton->second;
+        }
+        auto type = by_type.find(std::type_index(typeid(atom)));
+        return type != by_type.end() ? type->second : nullptr;
+    }
+
+    GroundedCodec const* find(std::string const& name) const {
+        auto codec = by_name.find(name);
+        return codec != by_name.end() ? &codec->second : nullptr;
+    }
+
+private:
+    std::unordered_map<std::string, GroundedCodec> by_name;
+    std::unordered_map<std::type_index, GroundedCodec const*> by_type;
+    std::unordered_map<Atom const*, GroundedCodec const*> by_atom;
+};
+
+void register_grounded_type(std::string name, std::type_index type,
+        GroundedEncoder encoder, GroundedDecoder decoder) {
+    GroundedCodecRegistry::instance().add({ name, encoder, decoder }, &type, nullptr);
+}
+
+void register_grounded_atom(std::string name, AtomPtr atom) {
+    GroundedCodecRegistry::instance().add({ name,
+            [](Atom const&, BinaryWriter&) -> void { },
+            [atom](BinaryReader&) -> AtomPtr { return atom; } },
+            nullptr, atom.get());
+}
+
+size_t AtomEncoder::intern(std::string const& str) {
+    auto it = string_index.emplace(str, strings.size());
+    if (it.second) {
+        strings.push_back(str);
+    }
+    return it.first->second;
+}
+
+// Atoms are written in preorder using explicit stack, so deep expressions
+// don't overflow the call stack
+void AtomEncoder::encode(AtomPtr const& root) {
+    std::vector<Atom const*> stack{ root.get() };
+    while (!stack.empty()) {
+        Atom const* atom = stack.back();
+        stack.pop_back();
+        switch (atom->get_type()) {
+            case Atom::SYMBOL:
+                body.write_byte(SYMBOL_TAG);
+                body.write_varint(intern(static_cast<SymbolAtom const*>(atom)->get_symbol()));
+                break;
+            case Atom::VARIABLE:
+                body.write_byte(VARIABLE_TAG);
+                body.write_varint(intern(static_cast<VariableAtom const*>(atom)->get_name()));
+                break;
+            case Atom::EXPR: {
+                auto const& children = static_cast<ExprAtom const*>(atom)->get_children();
+                body.write_byte(EXPR_TAG);
+                body.write_varint(children.size());
+                for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                    stack.push_back(it->get());
+                }
+                break;
+            }
+            case Atom::GROUNDED: {
+                GroundedCodec const* codec = GroundedCodecRegistry::instance().find(*atom);
+                if (!codec) {
+                    throw std::runtime_error("No codec is registered for grounded atom: " +
+                            atom->to_string());
+                }
+                auto it = codec_index.emplace(codec->name, codecs.size());
+                if (it.second) {
+                    codecs.push_back(codec->name);
+                }
+                body.write_byte(GROUNDED_TAG);
+                body.write_varint(it.first->second);
+                codec->encoder(*atom, body);
+                break;
+            }
+        }
+    }
+    ++count;
+}
+
+void AtomEncoder::write(std::ostream& out) const {
+    BinaryWriter header;
+    header.write_bytes(MAGIC, sizeof(MAGIC));
+    header.write_varint(VERSION);
+    header.write_varint(strings.size());
+    for (auto const& str : strings) {
+        header.write_string(str);
+    }
+    header.write_varint(codecs.size());
+    for (auto const& name : codecs) {
+        header.write_string(name);
+    }
+    header.write_varint(count);
+    out.write(header.get_data().data(), header.get_data().size());
+    out.write(body.get_data().data(), body.get_data().size());
+}
+
+AtomDecoder::AtomDecoder(char const* begin, char const* end)
+    : reader(begin, end), body(nullptr), end(end) {
+    if (std::memcmp(reader.read_bytes(sizeof(MAGIC)), MAGIC, sizeof(MAGIC))) {
+        throw std::runtime_error("Data is not a binary atoms data");
+    }
+    uint64_t version = reader.read_varint();
+    if (version != VERSION) {
+        throw std::runtime_error("Unsupported binary atoms data version: " +
+                std::to_string(version));
+    }
+    // each string and codec name takes at least one byte
+    size_t strings_size = reader.read_varint();
+    if (strings_size > reader.remaining()) {
+        throw std::runtime_error("Incorrect strings table size in binary atoms data");
+    }
+    strings.resize(strings_size);
+    for (auto& str : strings) {
+        str = reader.read_string();
+    }
+    symbols.resize(strings.size());
+    variables.resize(strings.size());
+    size_t codecs_size = reader.read_varint();
+    if (codecs_size > reader.remaining()) {
+        throw std::runtime_error("Incorrect codecs table size in binary atoms data");
+    }
+    codecs.resize(codecs_size);
+    for (auto& codec : codecs) {
+        std::string name = reader.read_string();
+        codec = GroundedCodecRegistry::instance().find(name);
+        if (!codec) {
+            throw std::runtime_error("No codec is registered for grounded atom: " + name);
+        }
+    }
+    count = reader.read_varint();
+    // each atom takes at least two bytes
+    if (count > reader.remaining() / 2) {
+        throw std::runtime_error("Incorrect number of atoms in binary atoms data");
+    }
+    body = reader.get_pos();
+}
+
+AtomPtr AtomDecoder::decode_at(size_t offset) {
+    if (offset >= static_cast<size_t>(end - body)) {
+        throw std::runtime_error("Incorrect atom offset in binary atoms data");
+    }
+    reader = BinaryReader(body + offset, end);
+    return decode();
+}
+
+AtomPtr const& AtomDecoder::name_atom(Atom::Type type, size_t index) {
+    if (index >= strings.size()) {
+        throw std::runtime_error("Incorrect string index in binary atoms data");
+    }
+    AtomPtr& atom = (type == Atom::SYMBOL ? symbols : variables)[index];
+    if (!atom) {
+        if (type == Atom::SYMBOL) {
+            atom = S(strings[index]);
+        } else {
+            atom = V(strings[index]);
+        }
+    }
+    return atom;
+}
+
+AtomPtr AtomDecoder::decode() {
+    struct Frame {
+        std::vector<AtomPtr> children;
+        size_t size;
+    };
+    std::vector<Frame> stack;
+    while (true) {
+        AtomPtr atom;
+        uint8_t tag = reader.read_byte();
+        switch (tag) {
+            case SYMBOL_TAG:
+                atom = name_atom(Atom::SYMBOL, reader.read_varint());
+                break;
+            case VARIABLE_TAG:
+                atom = name_atom(Atom::VARIABLE, reader.read_varint());
+                break;
+            case EXPR_TAG: {
+                size_t size = reader.read_varint();
+                // each child takes at least two bytes
+                if (size > reader.remaining() / 2) {
+                    throw std::runtime_error("Incorrect expression size in binary atoms data");
+                }
+                if (size > 0) {
+                    stack.push_back({ {}, size });
+                    stack.back().children.reserve(size);
+                    continue;
+                }
+                atom = E(std::vector<AtomPtr>());
+                break;
+            }
+            case GROUNDED_TAG: {
+                size_t index = reader.read_varint();
+                if (index >= codecs.size()) {
+                    throw std::runtime_error("Incorrect codec index in binary atoms data");
+                }
+                atom = codecs[index]->decoder(reader);
+                break;
+            }
+            default:
+                throw std::runtime_error("Unexpected tag in binary atoms data: " +
+                        std::to_string(tag));
+        }
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+            frame.children.push_back(std::move(atom));
+            if (frame.children.size() < frame.size) {
+                break;
+            }
+            atom = E(std::move(frame.children));
+            stack.pop_back();
+        }
+        if (stack.empty()) {
+            return atom;
+        }
+    }
+}
+
+void serialize(std::vector<AtomPtr> const& atoms, std::ostream& out) {
+    AtomEncoder encoder;
+    for (auto const& atom : atoms) {
+        encoder.encode(atom);
+    }
+    encoder.write(out);
+}
+
+std::vector<AtomPtr> deserialize(char const* begin, char const* end) {
+    AtomDecoder decoder(begin, end);
+    std::vector<AtomPtr> atoms;
+    atoms.reserve(decoder.get_count());
+    for (size_t i = 0; i < decoder.get_count(); ++i) {
+        atoms.push_back(decoder.decode());
+    }
+    return atoms;
+}
+
+// Size of seekable stream is known, so data is read at once without
+// reallocations; other streams are read by chunks
+std::vector<AtomPtr> deserialize(std::istream& in) {
+    std::string data;
+    std::istream::pos_type begin = in.tellg();
+    if (begin != std::istream::pos_type(-1) && in.seekg(0, std::ios::end)) {
+        std::istream::pos_type end = in.tellg();
+        in.seekg(begin);
+        data.resize(static_cast<size_t>(end - begin));
+        in.read(&data[0], data.size());
+        if (static_cast<size_t>(in.gcount()) != data.size()) {
+            throw std::runtime_error("Could not read binary atoms data from stream");
+        }
+        return deserialize(data.data(), data.data() + data.size());
+    }
+    in.clear();
+    size_t const chunk_size = 1024 * 1024;
+    while (in) {
+        size_t size = data.size();
+        data.resize(size + chunk_size);
+        in.read(&data[size], chunk_size);
+        data.resize(size + in.gcount());
+    }
+    if (in.bad()) {
+        throw std::runtime_error("Could not read binary atoms data from stream");
+    }
+    return deserialize(data.data(), data.data() + data.size());
+}
@@ -0,0 +1,162 @@
+#ifndef SERIALIZATION_H
+#define SERIALIZATION_H
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "GroundingSpace.h"
+
+// Binary serialization of atoms
+//
+// Format: magic, version, table of strings (symbols and variable names),
+// table of grounded atom codec names, number of atoms and atoms encoded in
+// preorder. Each atom starts from the tag: symbol and variable are followed
+// by the index of the name in strings table, expression is followed by the
+// number of children, grounded atom is followed by the index of the codec
+// and codec specific payload. Integers are encoded as LEB128 varints.
+
+class BinaryWriter {
+public:
+    void write_byte(uint8_t byte) { data.push_back(static_cast<char>(byte)); }
+    void write_varint(uint64_t value) {
+        while (value >= 0x80) {
+            write_byte(static_cast<uint8_t>(value) | 0x80);
+            value >>= 7;
+        }
+        write_byte(static_cast<uint8_t>(value));
+    }
+    void write_fixed32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            write_byte(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    void write_bytes(char const* bytes, size_t size) { data.append(bytes, size); }
+    void write_string(std::string const& str) {
+        write_varint(str.size());
+        write_bytes(str.data(), str.size());
+    }
+    std::string const& get_data() const { return data; }
+
+private:
+    std::string data;
+};
+
+class BinaryReader {
+public:
+    BinaryReader(char const* begin, char const* end) : pos(begin), end(end) { }
+
+    uint8_t read_byte() {
+        check(1);
+        return static_cast<uint8_t>(*pos++);
+    }
+    uint64_t read_varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = read_byte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        throw std::runtime_error("Malformed varint in binary atoms data");
+    }
+    uint32_t read_fixed32() {
+        check(4);
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(pos[i])) << (8 * i);
+        }
+        pos += 4;
+        return value;
+    }
+    char const* read_bytes(size_t size) {
+        check(size);
+        char const* bytes = pos;
+        pos += size;
+        return bytes;
+    }
+    std::string read_string() {
+        size_t size = read_varint();
+        return std::string(read_bytes(size), size);
+    }
+    size_t remaining() const { return end - pos; }
+    char const* get_pos() const { return pos; }
+
+private:
+    void check(size_t size) const {
+        if (static_cast<size_t>(end - pos) < size) {
+            throw std::runtime_error("Unexpected end of binary atoms data");
+        }
+    }
+
+    char const* pos;
+    char const* end;
+};
+
+// Grounded atoms are serialized by codecs registered by name. Codec of the
+// grounded atom type writes value of the atom and reads it back. Singleton
+// grounded atoms like operations are registered as atoms and are encoded by
+// name only.
+using GroundedEncoder = std::function<void(Atom const&, BinaryWriter&)>;
+using GroundedDecoder = std::function<AtomPtr(BinaryReader&)>;
+
+void register_grounded_type(std::string name, std::type_index type,
+        GroundedEncoder encoder, GroundedDecoder decoder);
+void register_grounded_atom(std::string name, AtomPtr atom);
+
+class AtomEncoder {
+public:
+    AtomEncoder() : count(0) { }
+    void encode(AtomPtr const& atom);
+    void write(std::ostream& out) const;
+    // Size of atoms encoded so far, it is an offset of the next atom which
+    // can be passed to AtomDecoder::decode_at()
+    size_t get_body_size() const { return body.get_data().size(); }
+
+private:
+    size_t intern(std::string const& str);
+
+    BinaryWriter body;
+    std::unordered_map<std::string, size_t> string_index;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, size_t> codec_index;
+    std::vector<std::string> codecs;
+    size_t count;
+};
+
+struct GroundedCodec;
+
+// Atoms with the same name are decoded as the same instance of the symbol
+// or variable, which is safe because atoms are immutable.
+class AtomDecoder {
+public:
+    AtomDecoder(char const* begin, char const* end);
+    size_t get_count() const { return count; }
+    AtomPtr decode();
+    AtomPtr decode_at(size_t offset);
+
+private:
+    AtomPtr const& name_atom(Atom::Type type, size_t index);
+
+    BinaryReader reader;
+    char const* body;
+    char const* end;
+    std::vector<std::string> strings;
+    std::vector<AtomPtr> symbols;
+    std::vector<AtomPtr> variables;
+    std::vector<GroundedCodec const*> codecs;
+    size_t count;
+};
+
+void serialize(std::vector<AtomPtr> const& atoms, std::ostream& out);
+std::vector<AtomPtr> deserialize(char const* begin, char const* end);
+std::vector<AtomPtr> deserialize(std::istream& in);
+
+#endif /* SERIALIZATION_H */
@@ -0,0 +1,84 @@
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include "SpaceAPI.h"
+
+class SpaceConverterRegistry {
+public:
+    static SpaceConverterRegistry& instance() {
+        static SpaceConverterRegistry registry;
+        return registry;
+    }
+
+    void add_converter(std::type_index from, std::type_index to, SpaceConverter converter) {
+        std::lock_guard<std::mutex> lock(mutex);
+        converters[std::make_pair(from, to)] = converter;
+    }
+
+    void add_source(std::type_index type, AtomSource source) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sources[type] = source;
+    }
+
+    void add_sink(std::type_index type, AtomSinkFactory sink) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sinks[type] = sink;
+    }
+
+    // Functions are copied under the lock and called without it, so
+    // converters can add spaces recursively
+    SpaceConverter find_converter(std::type_index from, std::type_index to) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto converter = converters.find(std::make_pair(from, to));
+        return converter != converters.end() ? converter->second : nullptr;
+    }
+
+    AtomSource find_source(std::type_index type) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto source = sources.find(type);
+        return source != sources.end() ? source->second : nullptr;
+    }
+
+    AtomSinkFactory find_sink(std::type_index type) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto sink = sinks.find(type);
+        return sink != sinks.end() ? sink->second : nullptr;
+    }
+
+private:
+    std::mutex mutex;
+    std::map<std::pair<std::type_index, std::type_index>, SpaceConverter> converters;
+    std::map<std::type_index, AtomSource> sources;
+    std::map<std::type_index, AtomSinkFactory> sinks;
+};
+
+void register_space_converter(std::type_index from, std::type_index to, SpaceConverter converter) {
+    SpaceConverterRegistry::instance().add_converter(from, to, converter);
+}
+
+void register_atom_source(std::type_index type, AtomSource source) {
+    SpaceConverterRegistry::instance().add_source(type, source);
+}
+
+void register_atom_sink(std::type_index type, AtomSinkFactory sink) {
+    SpaceConverterRegistry::instance().add_sink(type, sink);
+}
+
+bool convert_space(SpaceAPI const& from, SpaceAPI& to) {
+    SpaceConverterRegistry& registry = SpaceConverterRegistry::instance();
+    std::type_index from_type(typeid(from));
+    std::type_index to_type(typeid(to));
+    SpaceConverter converter = registry.find_converter(from_type, to_type);
+    if (converter) {
+        converter(from, to);
+        return true;
+    }
+    AtomSource source = registry.find_source(from_type);
+    AtomSinkFactory sink = source ? registry.find_sink(to_type) : nullptr;
+    if (source && sink) {
+        source(from, sink(to));
+        return true;
+    }
+    return false;
+}
@@ -1,8 +1,53 @@
 #ifndef SPACE_API_H
 #define SPACE_API_H
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <stdexcept>
+#include <typeindex>
+#include <typeinfo>
+
+class Atom;
+class SpaceAPI;
+
+using AtomSink = std::function<void(std::shared_ptr<Atom>)>;
+
+// Typed dispatch of SpaceAPI::add_to(). Conversions are looked up by the
+// dynamic types of the spaces. Converter registered for the pair of types is
+// used first. Otherwise atoms are streamed through the sink when the source
+// type has an atom source and the target type has an atom sink registered.
+using SpaceConverter = std::function<void(SpaceAPI const& from, SpaceAPI& to)>;
+using AtomSource = std::function<void(SpaceAPI const& from, AtomSink const& sink)>;
+using AtomSinkFactory = std::function<AtomSink(SpaceAPI& to)>;
+
+void register_space_converter(std::type_index from, std::type_index to, SpaceConverter converter);
+void register_atom_source(std::type_index type, AtomSource source);
+void register_atom_sink(std::type_index type, AtomSinkFactory sink);
+// Returns false when there is no conversion between types of the spaces
+bool convert_space(SpaceAPI const& from, SpaceAPI& to);
+
+template<typename From, typename To>
+void register_space_converter(std::function<void(From const&, To&)> converter) {
+    register_space_converter(typeid(From), typeid(To),
+            [converter](SpaceAPI const& from, SpaceAPI& to) -> void {
+                converter(static_cast<From const&>(from), static_cast<To&>(to));
+            });
+}
+
+template<typename From>
+void register_atom_source(std::function<void(From const&, AtomSink const&)> source) {
+    register_atom_source(typeid(From),
+            [source](SpaceAPI const& from, AtomSink const& sink) -> void {
+                source(static_cast<From const&>(from), sink);
+            });
+}
+
+template<typename To>
+void register_atom_sink(std::function<AtomSink(To&)> sink) {
+    register_atom_sink(typeid(To),
+            [sink](SpaceAPI& to) -> AtomSink { return sink(static_cast<To&>(to)); });
+}
 
 // In fact, all spaces are just grounded object nodes with certain interfaces.
 // In a more complete design, we should have GroundedObjectNode and SpaceAPI inherited from it,
@@ -15,6 +60,9 @@ public:
         // this is the primary function for overriding, because it's easier to traverse its own content
         // and add it to another container using its interface than to traverse a non-trivial container,
         // which implementation details can be hidden
+        if (convert_space(*this, graph)) {
+            return;
+        }
         if (get_type() == graph.get_type()) {
             graph.add_native(this);
         } else {
@@ -1,113 +1,336 @@
-#include <regex>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <stdexcept>
+#include <thread>
 
 #include "TextSpace.h"
+#include "MappedFile.h"
 
 // Text space
 
 std::string TextSpace::TYPE = "TextSpace";
 
-static void skip_space(char const*& text) {
-    while (*text && std::isspace(*text)) {
+static void skip_space(char const*& text, char const* end) {
+    while (text != end && std::isspace(*text)) {
         ++text;
     }
 }
 
-static std::string next_token(char const*& text) {
+static std::string next_token(char const*& text, char const* end) {
     char const* start = text;
     // TODO: this doesn't work for string in quotes with spaces inside them,
     // to fix it we should made TokenDescr more complex and use list of token
     // descriptions to build a parser
-    while (*text && !std::isspace(*text) && *text != '(' && *text != ')') {
+    while (text != end && !std::isspace(*text) && *text != '(' && *text != ')') {
         ++text;
     }
     return std::string(start, text);
 }
 
-static std::string show_position(char const* text, char const* pos) {
-    return std::string(text, pos) + ">" + std::string(1, *pos) + "<" +
-            (*pos ? std::string(pos + 1) : "");
+// Only part of the text around the position is shown, because text can be a
+// whole file
+static std::string show_position(char const* text, char const* end, char const* pos) {
+    size_t const context = 40;
+    char const* from = pos - std::min<size_t>(pos - text, context);
+    char const* to = pos == end ? end : pos + 1 + std::min<size_t>(end - pos - 1, context);
+    return std::string(from, pos) + ">" + (pos == end ? std::string("") : std::string(1, *pos)) +
+        "<" + (pos == end ? std::string("") : std::string(pos + 1, to));
 }
 
-static void parse_error(char const* text, char const* pos, std::string message) {
-    throw std::runtime_error(message + "\n" + show_position(text, pos));
-}
-
-AtomPtr TextSpace::find_token(char const*& text) const {
-    for (auto const& pair : tokens) {
-        std::cmatch match;
-        if (std::regex_search(text, match, pair.first, std::regex_constants::match_continuous)) {
-            text += match.length();
-            return pair.second(match.str());
-        }
-    }
-    return Atom::INVALID;
+static void parse_error(char const* text, char const* end, char const* pos, std::string message) {
+    throw std::runtime_error(message + "\n" + show_position(text, end, pos));
 }
 
 struct TextSpace::ParseResult {
     AtomPtr atom;
     bool is_eof;
+    // text ends inside of the expression
+    bool is_incomplete;
 };
 
-TextSpace::ParseResult  TextSpace::recursive_parse(char const* text, char const*& pos) const {
-    skip_space(pos);
-    switch (*pos) {
-        case '$':
-            ++pos;
-            return { V(next_token(pos)), false };
-        case '(':
-            {
+// Expressions are parsed using explicit stack of unfinished expressions
+// instead of recursion, so parsing deep expressions doesn't overflow stack
+TextSpace::ParseResult TextSpace::next_atom(char const* text, char const* end,
+        char const*& pos) const {
+    std::vector<std::vector<AtomPtr>> stack;
+    while (true) {
+        skip_space(pos, end);
+        if (pos == end) {
+            return { Atom::INVALID, true, !stack.empty() };
+        }
+        AtomPtr atom;
+        switch (*pos) {
+            case '$':
                 ++pos;
-                std::vector<AtomPtr> children;
-                while (true) {
-                    skip_space(pos);
-                    if (*pos == ')') {
-                        ++pos;
-                        break;
-                    }
-                    ParseResult result = recursive_parse(text, pos);
-                    if (result.is_eof) {
-                        parse_error(text, pos, "Unexpected end of expression");
-                    }
-                    children.push_back(result.atom);
+                atom = V(next_token(pos, end));
+                break;
+            case '(':
+                ++pos;
+                stack.emplace_back();
+                continue;
+            case ')':
+                if (stack.empty()) {
+                    parse_error(text, end, pos, "Unexpected right bracket");
+                }
+                ++pos;
+                atom = E(std::move(stack.back()));
+                stack.pop_back();
+                break;
+            default:
+                atom = tokenizer->find_token(pos, end);
+                if (!atom) {
+                    std::string token = next_token(pos, end);
+                    atom = S(token);
                 }
-                AtomPtr atom = E(children);
-                return { atom, false };
+                break;
+        };
+        if (stack.empty()) {
+            return { atom, false, false };
+        }
+        stack.back().push_back(atom);
+    }
+}
+
+char const* TextSpace::parse(char const* text, char const* end,
+        AtomSink const& sink, bool partial) const {
+    char const* pos = text;
+    while (true) {
+        char const* start = pos;
+        ParseResult result = next_atom(text, end, pos);
+        if (result.is_incomplete) {
+            if (partial) {
+                return start;
             }
-        case '\0':
-            return { Atom::INVALID, true };
-        default:
-            {
-                AtomPtr atom = find_token(pos);
-                if (atom) {
-                    return { atom, false };
-                } else {
-                    std::string token = next_token(pos);
-                    return { S(token), false };
+            parse_error(text, end, pos, "Unexpected end of expression");
+        }
+        if (result.is_eof) {
+            return end;
+        }
+        sink(result.atom);
+    }
+}
+
+void TextSpace::parse(std::string const& text, AtomSink sink) const {
+    parse(text.data(), text.data() + text.size(), sink, false);
+}
+
+// Text is read by chunks and only complete lines are parsed, so tokens
+// cannot be split between lines. When the last expression is not complete
+// it is kept in buffer and parsed again after the next chunk is read. Chunk
+// size grows with the buffer to not reparse long expressions too often.
+void TextSpace::parse(std::istream& in, AtomSink sink) const {
+    size_t const chunk_size = 64 * 1024;
+    std::string buffer;
+    bool eof = false;
+    while (!eof) {
+        size_t size = buffer.size();
+        size_t chunk = std::max(chunk_size, size);
+        buffer.resize(size + chunk);
+        in.read(&buffer[size], chunk);
+        buffer.resize(size + in.gcount());
+        if (in.bad()) {
+            throw std::runtime_error("Could not read text from stream");
+        }
+        eof = in.eof();
+        char const* begin = buffer.data();
+        char const* end = begin + (eof ? buffer.size() : buffer.rfind('\n') + 1);
+        char const* parsed = parse(begin, end, sink, !eof);
+        buffer.erase(0, parsed - begin);
+    }
+}
+
+// Scans brackets and quoted strings without matching other tokens, which is
+// correct when the rest of the tokens cannot contain brackets and quotes.
+// Parser has no comments syntax, so ';' is not special. Returns false when
+// the quote is not at the beginning of a token or the string is not closed:
+// such quote is matched by other tokens or it is a part of the symbol, then
+// scanning should be continued from the last split by the tokenizer.
+static bool split_by_brackets(char const* end, std::vector<char const*>& splits,
+        size_t chunk_size, std::vector<Tokenizer::Quote> const& quotes) {
+    enum QuoteKind : char { NO_QUOTE, QUOTE, ESCAPED_QUOTE };
+    QuoteKind kinds[256] = { NO_QUOTE };
+    for (auto const& quote : quotes) {
+        kinds[static_cast<unsigned char>(quote.quote)] = quote.escapes ? ESCAPED_QUOTE : QUOTE;
+    }
+    char const* pos = splits.back();
+    size_t depth = 0;
+    bool token_start = true;
+    while (pos != end) {
+        unsigned char c = *pos++;
+        if (c == '(') {
+            ++depth;
+            token_start = true;
+        } else if (c == ')') {
+            // unexpected bracket is reported by the parser
+            if (depth > 0 && --depth == 0 && pos >= splits.back() + chunk_size) {
+                splits.push_back(pos);
+            }
+            token_start = true;
+        } else if (std::isspace(c)) {
+            token_start = true;
+        } else if (kinds[c] != NO_QUOTE) {
+            if (!token_start) {
+                return false;
+            }
+            // dot of the escape doesn't match line ends
+            while (pos != end && *pos != static_cast<char>(c)) {
+                if (kinds[c] == ESCAPED_QUOTE && *pos == '\\') {
+                    if (++pos == end || *pos == '\n' || *pos == '\r') {
+                        return false;
+                    }
                 }
+                ++pos;
             }
-    };
+            if (pos == end) {
+                return false;
+            }
+            ++pos;
+        } else {
+            token_start = false;
+        }
+    }
+    return true;
 }
 
-void TextSpace::parse(std::string text, std::function<void(AtomPtr)> add) const {
-    char const* c_str = text.c_str();
-    char const* pos = c_str;
+// Continues splitting after the last split scanning the text the same way
+// next_atom() parses it but atoms are not constructed, so brackets inside of
+// any tokens are skipped exactly as the tokenizer matches them.
+void TextSpace::split_by_tokens(char const* end, std::vector<char const*>& splits,
+        size_t chunk_size) const {
+    size_t depth = 0;
+    char const* pos = splits.back();
     while (true) {
-        ParseResult result = recursive_parse(c_str, pos);
-        if (result.is_eof) {
+        skip_space(pos, end);
+        if (pos == end) {
             break;
         }
-        add(result.atom);
+        switch (*pos) {
+            case '$':
+                ++pos;
+                next_token(pos, end);
+                break;
+            case '(':
+                ++pos;
+                ++depth;
+                break;
+            case ')':
+                ++pos;
+                // unexpected bracket is reported by the parser
+                if (depth > 0 && --depth == 0 && pos >= splits.back() + chunk_size) {
+                    splits.push_back(pos);
+                }
+                break;
+            default:
+                if (!tokenizer->skip_token(pos, end)) {
+                    next_token(pos, end);
+                }
+                break;
+        }
+    }
+}
+
+// Looks for positions after top level expressions, text is split
+// approximately into chunks of the same size. Matching tokens is much slower
+// than parsing atoms in parallel, so brackets are scanned by chars unless
+// tokens can contain brackets.
+std::vector<char const*> TextSpace::split_text(char const* text, char const* end,
+        size_t chunks) const {
+    std::vector<char const*> splits{ text };
+    size_t chunk_size = (end - text) / chunks + 1;
+    std::vector<Tokenizer::Quote> quotes;
+    if (!tokenizer->get_quotes(quotes) || !split_by_brackets(end, splits, chunk_size, quotes)) {
+        split_by_tokens(end, splits, chunk_size);
     }
+    splits.push_back(end);
+    return splits;
 }
 
-void TextSpace::add_to(SpaceAPI& _space) const {
-    if (_space.get_type() == GroundingSpace::TYPE) {
-        GroundingSpace& space = static_cast<GroundingSpace&>(_space);
-        for (auto const& str_atom : code) {
-            parse(str_atom, [&space] (AtomPtr atom) -> void { space.add_atom(atom); });
+void TextSpace::parse_parallel(char const* text, char const* end, std::vector<AtomPtr>& atoms) const {
+    AtomSink sink = [&atoms](AtomPtr atom) -> void { atoms.push_back(atom); };
+    size_t const min_chunk_size = 64 * 1024;
+    size_t chunks = std::min<size_t>(threads * 4, (end - text) / min_chunk_size + 1);
+    if (threads == 1 || chunks == 1) {
+        parse(text, end, sink, false);
+        return;
+    }
+    std::vector<char const*> splits = split_text(text, end, chunks);
+    chunks = splits.size() - 1;
+    std::vector<std::vector<AtomPtr>> results(chunks);
+    std::vector<std::exception_ptr> errors(chunks);
+    std::atomic<size_t> next_chunk(0);
+    auto worker = [&]() -> void {
+        for (size_t i = next_chunk++; i < chunks; i = next_chunk++) {
+            std::vector<AtomPtr>& chunk = results[i];
+            try {
+                parse(splits[i], splits[i + 1],
+                        [&chunk](AtomPtr atom) -> void { chunk.push_back(atom); }, false);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threads, chunks); ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    for (auto const& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
         }
-    } else {
-        SpaceAPI::add_to(_space);
+    }
+    for (auto const& chunk : results) {
+        atoms.insert(atoms.end(), chunk.begin(), chunk.end());
     }
 }
+
+// Tokenizer passed to the constructor or shared with the copy of the space
+// is copied on the first write
+Tokenizer& TextSpace::own_tokenizer() {
+    if (!own) {
+        own = std::make_shared<Tokenizer>(*tokenizer);
+        tokenizer = own;
+    }
+    return *own;
+}
+
+void TextSpace::parse_to(AtomSink const& sink) const {
+    for (auto const& str_atom : code) {
+        parse(str_atom.data(), str_atom.data() + str_atom.size(), sink, false);
+    }
+    for (auto const& path : files) {
+        MappedFile file(path, MappedFile::SEQUENTIAL);
+        parse(file.begin(), file.end(), sink, false);
+    }
+}
+
+// Atoms are added into the space by single call after the whole text is
+// parsed, so nothing is added when text has an error
+void TextSpace::parse_to(GroundingSpace& space) const {
+    std::vector<AtomPtr> atoms;
+    for (auto const& str_atom : code) {
+        parse_parallel(str_atom.data(), str_atom.data() + str_atom.size(), atoms);
+    }
+    for (auto const& path : files) {
+        MappedFile file(path, MappedFile::SEQUENTIAL);
+        parse_parallel(file.begin(), file.end(), atoms);
+    }
+    space.add_atoms(atoms);
+}
+
+static struct RegisterTextSpaceConverters {
+    RegisterTextSpaceConverters() {
+        register_space_converter<TextSpace, GroundingSpace>(
+                [](TextSpace const& text, GroundingSpace& space) -> void {
+                    text.parse_to(space);
+                });
+        register_atom_source<TextSpace>(
+                [](TextSpace const& text, AtomSink const& sink) -> void {
+                    text.parse_to(sink);
+                });
+    }
+} register_text_space_converters;
@@ -3,10 +3,13 @@
 
 #include <vector>
 #include <functional>
+#include <istream>
+#include <memory>
 #include <regex>
 
 #include "SpaceAPI.h"
 #include "GroundingSpace.h"
+#include "Tokenizer.h"
 
 // Text space
 
@@ -15,13 +18,23 @@ public:
 
     static std::string TYPE;
 
-    using AtomConstr = std::function<AtomPtr(std::string)>;
-    using TokenDescr = std::pair<std::regex, AtomConstr>;
-
+    using AtomConstr = Tokenizer::AtomConstr;
+
+    TextSpace() : own(std::make_shared<Tokenizer>()), tokenizer(own), threads(1) { }
+    // Tokenizer should not be changed after it is passed to the space, then
+    // it can be shared between many text spaces and threads. Tokens
+    // registered in the space afterwards are added to the private copy of
+    // the tokenizer.
+    TextSpace(std::shared_ptr<Tokenizer const> tokenizer)
+        : tokenizer(tokenizer), threads(1) { }
+    // Copy shares the tokenizer unless it is changed by the original space,
+    // then tokenizer is copied
+    TextSpace(TextSpace const& other) : code(other.code), files(other.files),
+        tokenizer(other.own ? std::make_shared<Tokenizer const>(*other.own) : other.tokenizer),
+        threads(other.threads) { }
+    TextSpace& operator=(TextSpace const&) = delete;
     virtual ~TextSpace() { }
 
-    void add_to(SpaceAPI& space) const override;
-
     void add_native(const SpaceAPI* other) override {
         throw std::logic_error("Method is not implemented");
     }
@@ -32,25 +45,75 @@ public:
         code.push_back(str_atom);
     }
 
+    // File is not read until space is added to another space, then it is
+    // mapped into memory and parsed atom by atom.
+    void add_file(std::string path) {
+        files.push_back(path);
+    }
+
     // TODO: We could make this method static and allow registering tokens
     // globally, but on the other hand when it is not static we can register
     // separate set of tokens in each TextSpace and allow using different
     // parsers in parallel. Last solution looks more flexible. We could also
     // pass list of tokens into TextSpace constructor.
     void register_token(std::regex regex, AtomConstr constructor) {
-        tokens.push_back(TokenDescr(regex, constructor));
+        own_tokenizer().register_token(regex, constructor);
     }
+    // Regex passed as a string is analyzed and plain literals are matched
+    // without std::regex which is much faster.
+    void register_token(std::string regex, AtomConstr constructor) {
+        own_tokenizer().register_token(regex, constructor);
+    }
+    std::shared_ptr<Tokenizer const> get_tokenizer() const { return tokenizer; }
+
+    // When more than one thread is set, strings and files are split between
+    // top level expressions and parsed in parallel, atoms are added into the
+    // space in the source order. Token constructors should be thread safe.
+    void set_threads(size_t threads) {
+        this->threads = threads > 0 ? threads : 1;
+    }
+
+    // Parse text passing each top level atom into sink as soon as it is
+    // parsed. Stream is read by chunks, so whole text is not kept in memory.
+    // Chunks are parsed up to the last line end, so tokens read from the
+    // stream must not contain line ends: string token which spans lines is
+    // not matched as a single token. Use parse() of the string or add_file()
+    // to parse such text.
+    void parse(std::string const& text, AtomSink sink) const;
+    void parse(std::istream& in, AtomSink sink) const;
+    // Parse all strings and files added to the space. These are used by
+    // SpaceAPI::add_to() to add the text to any space which has an atom sink
+    // registered, GroundingSpace is filled in parallel.
+    void parse_to(AtomSink const& sink) const;
+    void parse_to(GroundingSpace& space) const;
 
 private:
 
     struct ParseResult;
 
-    AtomPtr find_token(const char*& text) const;
-    ParseResult  recursive_parse(char const* text, char const*& pos) const;
-    void parse(std::string text, std::function<void(AtomPtr)> add) const;
+    ParseResult next_atom(char const* text, char const* end, char const*& pos) const;
+    // Returns position after the last parsed atom. When partial is true
+    // incomplete expression at the end of the text is not an error and is
+    // left unparsed.
+    char const* parse(char const* text, char const* end,
+            AtomSink const& sink, bool partial) const;
+    // Returns positions after top level expressions which split the text
+    // into chunks, the first position is text and the last one is end
+    std::vector<char const*> split_text(char const* text, char const* end,
+            size_t chunks) const;
+    void split_by_tokens(char const* end, std::vector<char const*>& splits,
+            size_t chunk_size) const;
+    // Appends parsed atoms to the atoms vector
+    void parse_parallel(char const* text, char const* end, std::vector<AtomPtr>& atoms) const;
+    Tokenizer& own_tokenizer();
 
     std::vector<std::string> code; 
-    std::vector<TokenDescr> tokens;
+    std::vector<std::string> files;
+    // private tokenizer which can be changed, it is the same as tokenizer
+    // when set
+    std::shared_ptr<Tokenizer> own;
+    std::shared_ptr<Tokenizer const> tokenizer;
+    size_t threads;
 };
 
 #endif /* TEXT_SPACE_H */
@@ -0,0 +1,322 @@
+#include <cctype>
+#include <limits>
+
+#include "Tokenizer.h"
+
+// Tokenizer
+
+size_t const Tokenizer::NO_TOKEN = std::numeric_limits<size_t>::max();
+
+// Splits regex into the list of literal alternatives, returns false when
+// regex contains anything but escaped or plain chars and top level |
+static bool parse_literals(std::string const& regex, std::vector<std::string>& literals) {
+    literals.emplace_back();
+    for (size_t i = 0; i < regex.size(); ++i) {
+        char c = regex[i];
+        if (c == '\\') {
+            if (i + 1 == regex.size() || std::isalnum(static_cast<unsigned char>(regex[i + 1]))) {
+                return false;
+            }
+            literals.back().push_back(regex[++i]);
+        } else if (c == '|') {
+            literals.emplace_back();
+        } else if (std::string("^$.*+?()[]{}").find(c) != std::string::npos) {
+            return false;
+        } else {
+            literals.back().push_back(c);
+        }
+    }
+    for (auto const& literal : literals) {
+        if (literal.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void add_escape_class(char c, std::bitset<256>& chars) {
+    for (int i = 0; i < 256; ++i) {
+        bool matches = (c == 'd' && std::isdigit(i))
+            || (c == 'w' && (std::isalnum(i) || i == '_'))
+            || (c == 's' && std::isspace(i));
+        if (matches) {
+            chars.set(i);
+        }
+    }
+}
+
+// Returns false when char class is too complex to be analyzed
+static bool parse_char_class(std::string const& regex, size_t& i, std::bitset<256>& chars) {
+    bool negate = regex[i] == '^';
+    if (negate) {
+        ++i;
+    }
+    std::bitset<256> matched;
+    bool first = true;
+    while (i < regex.size() && (regex[i] != ']' || first)) {
+        first = false;
+        unsigned char from = regex[i];
+        if (from == '[') {
+            return false;
+        }
+        if (from == '\\') {
+            if (++i == regex.size()) {
+                return false;
+            }
+            char escaped = regex[i];
+            if (escaped == 'd' || escaped == 'w' || escaped == 's') {
+                add_escape_class(escaped, matched);
+                ++i;
+                continue;
+            }
+            if (std::isalnum(static_cast<unsigned char>(escaped))) {
+                return false;
+            }
+            from = escaped;
+        }
+        ++i;
+        unsigned char to = from;
+        if (i + 1 < regex.size() && regex[i] == '-' && regex[i + 1] != ']') {
+            to = regex[i + 1];
+            if (to == '\\' || to == '[') {
+                return false;
+            }
+            i += 2;
+        }
+        for (int c = from; c <= to; ++c) {
+            matched.set(c);
+        }
+    }
+    if (i == regex.size()) {
+        return false;
+    }
+    ++i;
+    chars = negate ? ~matched : matched;
+    return true;
+}
+
+// Returns set of chars which can start the match of the regex, the set is
+// conservative: all chars are returned when regex is not simple enough
+static std::bitset<256> first_chars(std::string const& regex) {
+    std::bitset<256> all;
+    all.set();
+    if (regex.empty() || regex.find('|') != std::string::npos) {
+        return all;
+    }
+    std::bitset<256> chars;
+    size_t i = 0;
+    char c = regex[i++];
+    if (c == '\\') {
+        if (i == regex.size()) {
+            return all;
+        }
+        char escaped = regex[i++];
+        if (escaped == 'd' || escaped == 'w' || escaped == 's') {
+            add_escape_class(escaped, chars);
+        } else if (std::isalnum(static_cast<unsigned char>(escaped))) {
+            return all;
+        } else {
+            chars.set(static_cast<unsigned char>(escaped));
+        }
+    } else if (c == '[') {
+        if (!parse_char_class(regex, i, chars)) {
+            return all;
+        }
+    } else if (std::string("^$.*+?()]{}").find(c) != std::string::npos) {
+        return all;
+    } else {
+        chars.set(static_cast<unsigned char>(c));
+    }
+    // first atom can be skipped
+    if (i < regex.size() && (regex[i] == '*' || regex[i] == '?' || regex[i] == '{')) {
+        return all;
+    }
+    return chars;
+}
+
+// Returns set of chars which can be matched by the regex, the set is
+// conservative: all chars are returned when regex is not simple enough
+static std::bitset<256> regex_chars(std::string const& regex) {
+    std::bitset<256> all;
+    all.set();
+    std::bitset<256> chars;
+    size_t i = 0;
+    while (i < regex.size()) {
+        char c = regex[i++];
+        if (c == '\\') {
+            if (i == regex.size()) {
+                return all;
+            }
+            char escaped = regex[i++];
+            if (escaped == 'd' || escaped == 'w' || escaped == 's') {
+                add_escape_class(escaped, chars);
+            } else if (std::isalnum(static_cast<unsigned char>(escaped))) {
+                return all;
+            } else {
+                chars.set(static_cast<unsigned char>(escaped));
+            }
+        } else if (c == '[') {
+            std::bitset<256> matched;
+            if (!parse_char_class(regex, i, matched)) {
+                return all;
+            }
+            chars |= matched;
+        } else if (c == '{') {
+            // repetition count
+            i = regex.find('}', i);
+            if (i == std::string::npos) {
+                return all;
+            }
+            ++i;
+        } else if (c == '.') {
+            return all;
+        } else if (std::string("^$*+?()|").find(c) == std::string::npos) {
+            chars.set(static_cast<unsigned char>(c));
+        }
+    }
+    return chars;
+}
+
+// Recognizes regexes of quoted strings without and with escapes like
+// '[^']*' and "([^"\\]|\\.)*", returns quote char or 0
+static char parse_quote(std::string const& regex, bool& escapes) {
+    for (char quote : { '\'', '"' }) {
+        std::string q(1, quote);
+        if (regex == q + "[^" + q + "]*" + q) {
+            escapes = false;
+            return quote;
+        }
+        for (std::string group : { "(", "(?:" }) {
+            if (regex == q + group + "[^" + q + "\\\\]|\\\\.)*" + q) {
+                escapes = true;
+                return quote;
+            }
+        }
+    }
+    return 0;
+}
+
+void Tokenizer::register_token(std::regex regex, AtomConstr constructor) {
+    CharSet all;
+    all.set();
+    add_token({ regex, constructor, all, all, 0, false }, {});
+}
+
+void Tokenizer::register_token(std::string regex, AtomConstr constructor) {
+    std::vector<std::string> literals;
+    if (!parse_literals(regex, literals)) {
+        literals.clear();
+    }
+    bool escapes = false;
+    char quote = parse_quote(regex, escapes);
+    add_token({ std::regex(regex), constructor, first_chars(regex),
+            regex_chars(regex), quote, escapes }, literals);
+}
+
+void Tokenizer::add_token(Token token, std::vector<std::string> const& literals) {
+    size_t index = tokens.size();
+    tokens.push_back(token);
+    if (literals.empty()) {
+        regex_tokens.push_back(index);
+    }
+    for (size_t i = 0; i < literals.size(); ++i) {
+        add_literal(literals[i], index, i);
+    }
+}
+
+void Tokenizer::add_literal(std::string const& literal, size_t token, size_t alternative) {
+    size_t node = 0;
+    for (char c : literal) {
+        auto next = trie[node].next.find(c);
+        if (next == trie[node].next.end()) {
+            trie.emplace_back();
+            next = trie[node].next.emplace(c, trie.size() - 1).first;
+        }
+        node = next->second;
+    }
+    // token registered earlier has priority
+    if (trie[node].token == NO_TOKEN) {
+        trie[node].token = token;
+        trie[node].alternative = alternative;
+    }
+}
+
+size_t Tokenizer::match(char const* text, char const* end, size_t& length) const {
+    // alternatives of the same literal token are prioritized in order of
+    // appearance as std::regex does
+    size_t token = NO_TOKEN;
+    size_t alternative = 0;
+    size_t node = 0;
+    for (char const* pos = text; pos != end; ++pos) {
+        auto next = trie[node].next.find(*pos);
+        if (next == trie[node].next.end()) {
+            break;
+        }
+        node = next->second;
+        TrieNode const& found = trie[node];
+        if (found.token < token || (found.token == token && found.alternative < alternative)) {
+            token = found.token;
+            alternative = found.alternative;
+            length = pos + 1 - text;
+        }
+    }
+    unsigned char first = *text;
+    for (size_t index : regex_tokens) {
+        if (index > token) {
+            break;
+        }
+        Token const& descr = tokens[index];
+        if (!descr.first_chars.test(first)) {
+            continue;
+        }
+        std::cmatch match;
+        if (std::regex_search(text, end, match, descr.regex, std::regex_constants::match_continuous)) {
+            length = match.length();
+            return index;
+        }
+    }
+    return token;
+}
+
+AtomPtr Tokenizer::find_token(char const*& text, char const* end) const {
+    size_t length = 0;
+    size_t token = match(text, end, length);
+    if (token == NO_TOKEN) {
+        return Atom::INVALID;
+    }
+    std::string str(text, length);
+    text += length;
+    return tokens[token].constructor(str);
+}
+
+bool Tokenizer::skip_token(char const*& text, char const* end) const {
+    size_t length = 0;
+    if (match(text, end, length) == NO_TOKEN) {
+        return false;
+    }
+    text += length;
+    return true;
+}
+
+bool Tokenizer::get_quotes(std::vector<Quote>& quotes) const {
+    CharSet quote_chars;
+    for (Token const& token : tokens) {
+        if (token.quote) {
+            unsigned char quote = token.quote;
+            // other token of the same quote is matched when the first one
+            // doesn't match
+            if (quote_chars.test(quote)) {
+                return false;
+            }
+            quote_chars.set(quote);
+            quotes.push_back({ token.quote, token.escapes });
+        }
+    }
+    for (Token const& token : tokens) {
+        if (!token.quote && (token.chars.test('(') || token.chars.test(')')
+                    || (token.chars & quote_chars).any())) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <bitset>
+#include <functional>
+#include <map>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "GroundingSpace.h"
+
+// Tokenizer
+
+// Keeps the list of tokens registered by user and looks for the token which
+// matches the beginning of the text. When more than one token matches the
+// token registered first wins. Tokens which regexes are plain literals (or
+// alternatives of literals) are kept in a trie, other tokens are matched by
+// std::regex but only when the first char of the text can start the match.
+class Tokenizer {
+public:
+
+    using AtomConstr = std::function<AtomPtr(std::string)>;
+
+    // Quoted string token: from the quote char to the next quote char, when
+    // escapes is true backslash escapes any char but line end
+    struct Quote {
+        char quote;
+        bool escapes;
+    };
+
+    void register_token(std::regex regex, AtomConstr constructor);
+    void register_token(std::string regex, AtomConstr constructor);
+
+    // Returns atom constructed from the token found at the beginning of
+    // [text, end) and moves text after the token, returns Atom::INVALID when
+    // no token matches.
+    AtomPtr find_token(char const*& text, char const* end) const;
+    // Moves text after the token found at the beginning of [text, end) the
+    // same way find_token() does, but doesn't construct an atom. Returns
+    // false when no token matches.
+    bool skip_token(char const*& text, char const* end) const;
+    // Returns quoted string tokens when they are the only tokens which can
+    // contain brackets or quote chars, then brackets outside of the quotes
+    // can be scanned without matching tokens. Returns false when other
+    // tokens can contain them or regex is too complex to be analyzed.
+    bool get_quotes(std::vector<Quote>& quotes) const;
+
+private:
+
+    using CharSet = std::bitset<256>;
+
+    struct Token {
+        std::regex regex;
+        AtomConstr constructor;
+        CharSet first_chars;
+        // chars which can be matched by the token
+        CharSet chars;
+        // quote char when token is a quoted string, otherwise 0
+        char quote;
+        bool escapes;
+    };
+
+    struct TrieNode {
+        std::map<char, size_t> next;
+        // index of the token and the alternative of the token which ends at
+        // the node
+        size_t token = NO_TOKEN;
+        size_t alternative = 0;
+    };
+
+    static size_t const NO_TOKEN;
+
+    void add_token(Token token, std::vector<std::string> const& literals);
+    void add_literal(std::string const& literal, size_t token, size_t alternative);
+    // Returns index of the token found at the beginning of the text and its
+    // length, or NO_TOKEN
+    size_t match(char const* text, char const* end, size_t& length) const;
+
+    std::vector<Token> tokens;
+    // indexes of tokens which are matched by std::regex
+    std::vector<size_t> regex_tokens;
+    std::vector<TrieNode> trie{ TrieNode() };
+};
+
+#endif /* TOKENIZER_H */
@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include "Tracer.h"
+
+size_t const Tracer::DEFAULT_CAPACITY = 1 << 16;
+
+std::atomic<bool> Tracer::enabled(false);
+
+static std::atomic<int64_t> start_time(0);
+
+static int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Buffer is locked by the owning thread on each event, the lock is not
+// contended unless events are collected at the same time
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+    // number of events written, next event is written at count % size
+    uint64_t count;
+    uint32_t thread;
+};
+
+using ThreadBufferPtr = std::shared_ptr<ThreadBuffer>;
+
+// Buffers outlive their threads to keep events for the export
+class ThreadBufferRegistry {
+public:
+    static ThreadBufferRegistry& instance() {
+        static ThreadBufferRegistry registry;
+        return registry;
+    }
+
+    ThreadBufferPtr create() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ThreadBufferPtr buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(capacity);
+        buffer->count = 0;
+        buffer->thread = next_thread++;
+        buffers.push_back(buffer);
+        return buffer;
+    }
+
+    // Buffers of finished threads are released, buffers of running threads
+    // are emptied and resized
+    void reset(size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->capacity = capacity;
+        reset_buffers();
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        reset_buffers();
+    }
+
+    std::vector<TraceEvent> get_events() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<TraceEvent> events;
+        for (auto const& buffer : buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            uint64_t size = buffer->events.size();
+            uint64_t first = buffer->count > size ? buffer->count - size : 0;
+            for (uint64_t i = first; i < buffer->count; ++i) {
+                events.push_back(buffer->events[i % size]);
+                events.back().thread = buffer->thread;
+            }
+        }
+        std::stable_sort(events.begin(), events.end(),
+                [](TraceEvent const& a, TraceEvent const& b) -> bool {
+                    return a.time < b.time;
+                });
+        return events;
+    }
+
+private:
+    ThreadBufferRegistry() : capacity(Tracer::DEFAULT_CAPACITY), next_thread(1) { }
+
+    void reset_buffers() {
+        buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                    [](ThreadBufferPtr const& buffer) -> bool {
+                        return buffer.use_count() == 1;
+                    }), buffers.end());
+        for (auto const& buffer : buffers) {
+            std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+            buffer->events.assign(capacity, TraceEvent());
+            buffer->count = 0;
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<ThreadBufferPtr> buffers;
+    size_t capacity;
+    uint32_t next_thread;
+};
+
+static thread_local ThreadBufferPtr thread_buffer;
+
+void Tracer::enable(size_t capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("Trace buffer capacity should be positive");
+    }
+    disable();
+    ThreadBufferRegistry::instance().reset(capacity);
+    start_time.store(now(), std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::clear() {
+    ThreadBufferRegistry::instance().reset();
+}
+
+void Tracer::record_event(TraceEvent::Type type, uint64_t atom, uint64_t value) {
+    if (!thread_buffer) {
+        thread_buffer = ThreadBufferRegistry::instance().create();
+    }
+    ThreadBuffer& buffer = *thread_buffer;
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    TraceEvent& event = buffer.events[buffer.count % buffer.events.size()];
+    event.time = now() - start_time.load(std::memory_order_relaxed);
+    event.atom = atom;
+    event.value = value;
+    event.type = type;
+    ++buffer.count;
+}
+
+std::vector<TraceEvent> Tracer::get_events() {
+    return ThreadBufferRegistry::instance().get_events();
+}
+
+struct ChromeEventFormat {
+    char const* name;
+    char const* phase;
+    char const* value;
+};
+
+static ChromeEventFormat const CHROME_EVENT_FORMATS[] = {
+    { "step", "B", nullptr },
+    { "step", "E", nullptr },
+    { "grounded call", "B", nullptr },
+    { "grounded call", "E", nullptr },
+    { "rules matched", "i", "rules" },
+    { "match scan", "i", "candidates" },
+};
+
+void Tracer::write_chrome_trace(std::ostream& out) {
+    std::vector<TraceEvent> events = get_events();
+    out << "{\"traceEvents\":[";
+    for (auto it = events.begin(); it != events.end(); ++it) {
+        ChromeEventFormat const& format = CHROME_EVENT_FORMATS[it->type];
+        out << (it == events.begin() ? "\n" : ",\n");
+        out << "{\"name\":\"" << format.name << "\",\"cat\":\"interpreter\"" <<
+            ",\"ph\":\"" << format.phase << "\"";
+        if (format.phase[0] == 'i') {
+            out << ",\"s\":\"t\"";
+        }
+        out << ",\"ts\":" << it->time / 1000 << '.' <<
+            std::setw(3) << std::setfill('0') << it->time % 1000 << std::setfill(' ') <<
+            ",\"pid\":1,\"tid\":" << it->thread <<
+            ",\"args\":{\"atom\":\"0x" << std::hex << it->atom << std::dec << "\"";
+        if (format.value) {
+            out << ",\"" << format.value << "\":" << it->value;
+        }
+        out << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+void Tracer::write_chrome_trace_file(std::string const& path) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Could not open file " + path + " for writing");
+    }
+    write_chrome_trace(out);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Could not write to file " + path);
+    }
+}
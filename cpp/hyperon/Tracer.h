@@ -0,0 +1,96 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "GroundingSpace.h"
+
+// Tracer
+
+// Binary trace of the interpreter events. Each thread writes events into its
+// own ring buffer of the fixed size, so only the latest events are kept and
+// tracing doesn't allocate memory after the buffer is created. When tracing
+// is disabled recording an event costs a single atomic load, so
+// instrumentation can be left in the code. Atoms are identified by address,
+// atom text is not recorded.
+
+struct TraceEvent {
+    enum Type : uint8_t {
+        STEP_BEGIN,
+        STEP_END,
+        GROUNDED_CALL_BEGIN,
+        GROUNDED_CALL_END,
+        // value is a number of the rules matched
+        RULES_MATCHED,
+        // value is a number of the candidates scanned by match or unify
+        MATCH_SCAN
+    };
+
+    // nanoseconds since the tracer is enabled
+    uint64_t time;
+    uint64_t atom;
+    uint64_t value;
+    uint32_t thread;
+    Type type;
+};
+
+class Tracer {
+public:
+
+    static size_t const DEFAULT_CAPACITY;
+
+    // Starts recording, capacity is a number of events kept per thread.
+    // Events recorded before are cleared.
+    static void enable(size_t capacity = DEFAULT_CAPACITY);
+    static void disable() { enabled.store(false, std::memory_order_relaxed); }
+    static bool is_enabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static void record(TraceEvent::Type type, Atom const* atom, uint64_t value = 0) {
+        if (is_enabled()) {
+            record_event(type, reinterpret_cast<uintptr_t>(atom), value);
+        }
+    }
+
+    // Returns events of all threads ordered by time
+    static std::vector<TraceEvent> get_events();
+    static void clear();
+
+    // Writes events in Chrome trace event format which can be opened by
+    // chrome://tracing or Perfetto UI
+    static void write_chrome_trace(std::ostream& out);
+    static void write_chrome_trace_file(std::string const& path);
+
+private:
+
+    static void record_event(TraceEvent::Type type, uint64_t atom, uint64_t value);
+
+    static std::atomic<bool> enabled;
+};
+
+// Records begin event at construction and end event at destruction, end
+// event is not recorded when begin event was not
+class TraceSpan {
+public:
+    TraceSpan(TraceEvent::Type begin, Atom const* atom)
+        : type(begin), atom(atom), recorded(Tracer::is_enabled()) {
+        if (recorded) {
+            Tracer::record(begin, atom);
+        }
+    }
+    ~TraceSpan() {
+        if (recorded) {
+            Tracer::record(static_cast<TraceEvent::Type>(type + 1), atom);
+        }
+    }
+
+private:
+    TraceEvent::Type type;
+    Atom const* atom;
+    bool recorded;
+};
+
+#endif /* TRACER_H */
@@ -3,31 +3,37 @@
 #include "GroundedArithmetic.h"
 #include "GroundedLogic.h"
 
-void Atomese::parse(std::string program, GroundingSpace& kb) const {
-    TextSpace parser;
-    init_parser(parser);
-    parser.add_string(program);
-    kb.add_from_space(parser);
+static void register_token_string_regex(Tokenizer& parser, std::string regex, Tokenizer::AtomConstr constr) {
+    parser.register_token(regex, constr);
 }
 
-static void register_token_string_regex(TextSpace& parser, std::string regex, TextSpace::AtomConstr constr) {
-    parser.register_token(std::regex(regex), constr);
-}
-
-static void register_token_without_params(TextSpace& parser, std::string regex, AtomPtr atom) {
+static void register_token_without_params(Tokenizer& parser, std::string regex, AtomPtr atom) {
     register_token_string_regex(parser, regex, [atom](std::string) -> AtomPtr { return atom; });
 }
 
-void Atomese::init_parser(TextSpace& parser) const {
-    register_token_without_params(parser, "\\+", ADD);
-    register_token_without_params(parser, "\\-", SUB);
-    register_token_without_params(parser, "\\*", MUL);
-    register_token_without_params(parser, "\\/", DIV);
-    register_token_without_params(parser, "==", EQ);
-    register_token_string_regex(parser, "\\d+(\\.\\d+)", [](std::string token) -> AtomPtr{
+static std::shared_ptr<Tokenizer const> create_tokenizer() {
+    std::shared_ptr<Tokenizer> parser = std::make_shared<Tokenizer>();
+    register_token_without_params(*parser, "\\+", ADD);
+    register_token_without_params(*parser, "\\-", SUB);
+    register_token_without_params(*parser, "\\*", MUL);
+    register_token_without_params(*parser, "\\/", DIV);
+    register_token_without_params(*parser, "==", EQ);
+    register_token_string_regex(*parser, "\\d+(\\.\\d+)", [](std::string token) -> AtomPtr{
                 return Float(::atof(token.c_str()));
             });
-    register_token_string_regex(parser, "\\d+", [](std::string token) -> AtomPtr{
+    register_token_string_regex(*parser, "\\d+", [](std::string token) -> AtomPtr{
                 return Int(::atoi(token.c_str()));
             });
+    return parser;
+}
+
+Atomese::Atomese() {
+    static std::shared_ptr<Tokenizer const> const atomese_tokenizer = create_tokenizer();
+    tokenizer = atomese_tokenizer;
+}
+
+void Atomese::parse(std::string program, GroundingSpace& kb) const {
+    TextSpace parser(tokenizer);
+    parser.add_string(program);
+    kb.add_from_space(parser);
 }
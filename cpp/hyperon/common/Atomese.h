@@ -1,17 +1,25 @@
 #ifndef ATOMESE_H
 #define ATOMESE_H
 
+#include <memory>
 #include <string>
 
 #include <hyperon/GroundingSpace.h>
 #include <hyperon/TextSpace.h>
+#include <hyperon/Tokenizer.h>
 
+// Tokens of the Atomese grammar are compiled once and shared by all
+// instances, so parse() pays only for parsing the program. It is safe to
+// call parse() from many threads.
 class Atomese {
 public:
+    Atomese();
+
     void parse(std::string program, GroundingSpace& kb) const;
+    std::shared_ptr<Tokenizer const> get_tokenizer() const { return tokenizer; }
 
 private:
-    void init_parser(TextSpace& parser) const;
+    std::shared_ptr<Tokenizer const> tokenizer;
 };
 
 #endif /* ATOMESE_H */
@@ -1,6 +1,12 @@
+#include <cstring>
+#include <functional>
+
+#include <hyperon/Serialization.h>
+
 #include "GroundedArithmetic.h"
+#include "GroundedLogic.h"
 
-template<typename T>
+template<typename T, typename R = T>
 class BinaryOpAtom : public GroundedAtom {
 public:
     BinaryOpAtom(std::string symbol) : symbol(symbol) { }
@@ -15,10 +21,10 @@ public:
             throw std::runtime_error("Cannot cast parameters to operation type, a: " +
                     _a->to_string() + ", b: " + _b->to_string());
         }
-        std::shared_ptr<T> c(operator()(a, b));
+        std::shared_ptr<R> c(operator()(a, b));
         result.add_atom(c);
     }
-    virtual T* operator() (T const* a, T const* b) const = 0;
+    virtual R* operator() (T const* a, T const* b) const = 0;
     bool operator==(Atom const& _other) const override { 
         return this == &_other;
     }
@@ -75,6 +81,26 @@ const GroundedAtomPtr SUB = std::make_shared<SubAtom>();
 const GroundedAtomPtr ADD = std::make_shared<PlusAtom>();
 const GroundedAtomPtr DIV = std::make_shared<DivAtom>();
 
+template<typename Compare>
+class NumCompareOpAtom : public BinaryOpAtom<NumAtom, BoolAtom> {
+public:
+    NumCompareOpAtom(std::string op) : BinaryOpAtom(op) { }
+    virtual ~NumCompareOpAtom() {}
+    BoolAtom* operator() (NumAtom const* a, NumAtom const* b) const override {
+        Compare compare;
+        if (a->get().type == NumValue::FLOAT || b->get().type == NumValue::FLOAT) {
+            return new BoolAtom(compare(a->get().get<float>(), b->get().get<float>()));
+        } else {
+            return new BoolAtom(compare(a->get().get<int>(), b->get().get<int>()));
+        }
+    }
+};
+
+const GroundedAtomPtr LESS = std::make_shared<NumCompareOpAtom<std::less<>>>("<");
+const GroundedAtomPtr GREATER = std::make_shared<NumCompareOpAtom<std::greater<>>>(">");
+const GroundedAtomPtr LESS_EQ = std::make_shared<NumCompareOpAtom<std::less_equal<>>>("<=");
+const GroundedAtomPtr GREATER_EQ = std::make_shared<NumCompareOpAtom<std::greater_equal<>>>(">=");
+
 class ConcatAtom : public BinaryOpAtom<StringAtom> {
 public:
     ConcatAtom() : BinaryOpAtom("++") {}
@@ -85,3 +111,43 @@ public:
 
 const GroundedAtomPtr CONCAT = std::make_shared<ConcatAtom>();
 
+
+static struct RegisterArithmeticCodecs {
+    RegisterArithmeticCodecs() {
+        register_grounded_type("NumAtom", typeid(NumAtom),
+                [](Atom const& atom, BinaryWriter& out) -> void {
+                    NumValue value = static_cast<NumAtom const&>(atom).get();
+                    uint32_t bits;
+                    std::memcpy(&bits, &value.value, sizeof(bits));
+                    out.write_byte(value.type);
+                    out.write_fixed32(bits);
+                },
+                [](BinaryReader& in) -> AtomPtr {
+                    uint8_t type = in.read_byte();
+                    uint32_t bits = in.read_fixed32();
+                    if (type == NumValue::INT) {
+                        int value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        return Int(value);
+                    } else {
+                        float value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        return Float(value);
+                    }
+                });
+        register_grounded_type("StringAtom", typeid(StringAtom),
+                [](Atom const& atom, BinaryWriter& out) -> void {
+                    out.write_string(static_cast<StringAtom const&>(atom).get());
+                },
+                [](BinaryReader& in) -> AtomPtr { return String(in.read_string()); });
+        register_grounded_atom("MUL", MUL);
+        register_grounded_atom("SUB", SUB);
+        register_grounded_atom("ADD", ADD);
+        register_grounded_atom("DIV", DIV);
+        register_grounded_atom("LESS", LESS);
+        register_grounded_atom("GREATER", GREATER);
+        register_grounded_atom("LESS_EQ", LESS_EQ);
+        register_grounded_atom("GREATER_EQ", GREATER_EQ);
+        register_grounded_atom("CONCAT", CONCAT);
+    }
+} register_arithmetic_codecs;
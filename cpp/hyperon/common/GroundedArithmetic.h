@@ -53,6 +53,12 @@ extern const GroundedAtomPtr MUL;
 extern const GroundedAtomPtr ADD;
 extern const GroundedAtomPtr DIV;
 
+// Comparisons of numbers, result is BoolAtom
+extern const GroundedAtomPtr LESS;
+extern const GroundedAtomPtr GREATER;
+extern const GroundedAtomPtr LESS_EQ;
+extern const GroundedAtomPtr GREATER_EQ;
+
 class StringAtom : public ValueAtom<std::string> {
 public:
     StringAtom(std::string value) : ValueAtom(value) {}
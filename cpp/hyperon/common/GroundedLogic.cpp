@@ -1,3 +1,5 @@
+#include <hyperon/Serialization.h>
+
 #include "GroundedLogic.h"
 
 const std::shared_ptr<BoolAtom> TRUE = std::shared_ptr<BoolAtom>(new BoolAtom(true));
@@ -45,3 +47,75 @@ public:
 };
 
 const GroundedAtomPtr IF = std::shared_ptr<IfAtom>(new IfAtom());
+
+static BoolAtom const* get_bool_arg(GroundingSpace const& args, size_t index) {
+    AtomPtr const& arg = args.get_content()[index];
+    BoolAtom const* value = dynamic_cast<BoolAtom const*>(arg.get());
+    if (!value) {
+        throw std::runtime_error("Cannot cast parameter to bool, parameter: " +
+                arg->to_string());
+    }
+    return value;
+}
+
+class BoolBinaryOpAtom : public GroundedAtom {
+public:
+    BoolBinaryOpAtom(std::string symbol) : symbol(symbol) { }
+    virtual ~BoolBinaryOpAtom() { }
+
+    void execute(GroundingSpace const& args, GroundingSpace& result) const override {
+        result.add_atom(Bool(operator()(get_bool_arg(args, 1)->get(),
+                        get_bool_arg(args, 2)->get())));
+    }
+    virtual bool operator() (bool a, bool b) const = 0;
+    bool operator==(Atom const& _other) const override {
+        return this == &_other;
+    }
+    std::string to_string() const override { return symbol; }
+private:
+    std::string symbol;
+};
+
+class AndAtom : public BoolBinaryOpAtom {
+public:
+    AndAtom() : BoolBinaryOpAtom("and") { }
+    bool operator() (bool a, bool b) const override { return a && b; }
+};
+
+class OrAtom : public BoolBinaryOpAtom {
+public:
+    OrAtom() : BoolBinaryOpAtom("or") { }
+    bool operator() (bool a, bool b) const override { return a || b; }
+};
+
+const GroundedAtomPtr AND = std::make_shared<AndAtom>();
+const GroundedAtomPtr OR = std::make_shared<OrAtom>();
+
+class NotAtom : public GroundedAtom {
+public:
+    virtual ~NotAtom() { }
+    void execute(GroundingSpace const& args, GroundingSpace& result) const override {
+        result.add_atom(Bool(!get_bool_arg(args, 1)->get()));
+    }
+    bool operator==(Atom const& _other) const override {
+        return this == &_other;
+    }
+    std::string to_string() const override { return "not"; }
+};
+
+const GroundedAtomPtr NOT = std::make_shared<NotAtom>();
+
+static struct RegisterLogicCodecs {
+    RegisterLogicCodecs() {
+        register_grounded_type("BoolAtom", typeid(BoolAtom),
+                [](Atom const& atom, BinaryWriter& out) -> void {
+                    out.write_byte(static_cast<BoolAtom const&>(atom).get());
+                },
+                [](BinaryReader& in) -> AtomPtr { return Bool(in.read_byte()); });
+        register_grounded_atom("EQ", EQ);
+        register_grounded_atom("IF", IF);
+        register_grounded_atom("AND", AND);
+        register_grounded_atom("OR", OR);
+        register_grounded_atom("NOT", NOT);
+    }
+} register_logic_codecs;
@@ -16,5 +16,8 @@ inline auto Bool(bool value) { return value ? TRUE : FALSE; }
 
 extern const GroundedAtomPtr EQ;
 extern const GroundedAtomPtr IF;
+extern const GroundedAtomPtr AND;
+extern const GroundedAtomPtr OR;
+extern const GroundedAtomPtr NOT;
 
 #endif /* GROUNDED_LOGIC_H */
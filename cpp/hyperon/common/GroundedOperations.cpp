@@ -0,0 +1,71 @@
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+#include "GroundedOperations.h"
+#include "GroundedArithmetic.h"
+#include "GroundedLogic.h"
+
+class GroundedOperationRegistry {
+public:
+    static GroundedOperationRegistry& instance() {
+        static GroundedOperationRegistry registry;
+        return registry;
+    }
+
+    void add(std::string name, GroundedAtomPtr operation) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!operations.emplace(name, operation).second) {
+            throw std::logic_error("Grounded operation is registered already: " + name);
+        }
+    }
+
+    GroundedAtomPtr find(std::string const& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto operation = operations.find(name);
+        return operation != operations.end() ? operation->second : nullptr;
+    }
+
+    std::vector<std::string> get_names() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> names;
+        for (auto const& operation : operations) {
+            names.push_back(operation.first);
+        }
+        return names;
+    }
+
+private:
+    // Builtin operations are added here and not by static initializers
+    // because order of initialization of the operation constants is not
+    // defined relative to other translation units
+    GroundedOperationRegistry() : operations({
+            { "+", ADD },
+            { "-", SUB },
+            { "*", MUL },
+            { "/", DIV },
+            { "<", LESS },
+            { ">", GREATER },
+            { "<=", LESS_EQ },
+            { ">=", GREATER_EQ },
+            { "==", EQ },
+            { "and", AND },
+            { "or", OR },
+            { "not", NOT },
+            { "++", CONCAT } }) { }
+
+    std::mutex mutex;
+    std::map<std::string, GroundedAtomPtr> operations;
+};
+
+void register_grounded_operation(std::string name, GroundedAtomPtr operation) {
+    GroundedOperationRegistry::instance().add(name, operation);
+}
+
+GroundedAtomPtr find_grounded_operation(std::string const& name) {
+    return GroundedOperationRegistry::instance().find(name);
+}
+
+std::vector<std::string> get_grounded_operation_names() {
+    return GroundedOperationRegistry::instance().get_names();
+}
@@ -0,0 +1,19 @@
+#ifndef GROUNDED_OPERATIONS_H
+#define GROUNDED_OPERATIONS_H
+
+#include <string>
+#include <vector>
+
+#include <hyperon/GroundingSpace.h>
+
+// Registry of native grounded operations by their symbol. It lets clients
+// like Python bindings select C++ implementation of the operation for the
+// token instead of executing their own one. Arithmetic, comparison, logic
+// and string operations are registered on the first access.
+
+void register_grounded_operation(std::string name, GroundedAtomPtr operation);
+// Returns nullptr when operation is not registered
+GroundedAtomPtr find_grounded_operation(std::string const& name);
+std::vector<std::string> get_grounded_operation_names();
+
+#endif /* GROUNDED_OPERATIONS_H */
@@ -1,6 +1,6 @@
 #include "common.h"
 
-AtomPtr interpret_until_result(GroundingSpace& target, GroundingSpace const& kb) {
+AtomPtr interpret_until_result(GroundingSpace& target, SpaceAPI const& kb) {
     AtomPtr result;
     do {
         result = target.interpret_step(kb);
@@ -3,6 +3,6 @@
 
 #include <hyperon/GroundingSpace.h>
 
-AtomPtr interpret_until_result(GroundingSpace& target, GroundingSpace const& kb);
+AtomPtr interpret_until_result(GroundingSpace& target, SpaceAPI const& kb);
 
 #endif /* INTERPRET_H */
@@ -0,0 +1,97 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "KbGenerator.h"
+
+KbGenerator::KbGenerator(KbGeneratorOptions const& options)
+    : options(options), random(options.seed), uniform(0.0, 1.0) {
+    if (options.symbols == 0 || options.arity == 0 || options.depth == 0) {
+        throw std::invalid_argument("Number of symbols, arity and depth should be positive");
+    }
+    ranks.reserve(options.symbols);
+    symbols.reserve(options.symbols);
+    double sum = 0;
+    for (size_t rank = 1; rank <= options.symbols; ++rank) {
+        sum += 1.0 / std::pow(rank, options.skew);
+        ranks.push_back(sum);
+        symbols.push_back(S("s" + std::to_string(rank)));
+    }
+    for (auto& rank : ranks) {
+        rank /= sum;
+    }
+    for (size_t i = 0; i < options.arity; ++i) {
+        variables.push_back(V("x" + std::to_string(i)));
+    }
+}
+
+AtomPtr KbGenerator::next_symbol() {
+    auto rank = std::lower_bound(ranks.begin(), ranks.end(), uniform(random));
+    if (rank == ranks.end()) {
+        --rank;
+    }
+    return symbols[rank - ranks.begin()];
+}
+
+// Expression is built using explicit stack, so big depth doesn't overflow
+// the call stack
+AtomPtr KbGenerator::next_expr(double variables) {
+    std::vector<std::vector<AtomPtr>> stack;
+    stack.emplace_back();
+    stack.back().push_back(next_symbol());
+    while (true) {
+        std::vector<AtomPtr>& children = stack.back();
+        if (children.size() == options.arity) {
+            AtomPtr expr = E(std::move(children));
+            stack.pop_back();
+            if (stack.empty()) {
+                return expr;
+            }
+            stack.back().push_back(expr);
+        } else if (stack.size() < options.depth && uniform(random) < options.nesting) {
+            stack.emplace_back();
+            stack.back().push_back(next_symbol());
+        } else if (uniform(random) < variables) {
+            size_t index = static_cast<size_t>(uniform(random) * options.arity);
+            children.push_back(this->variables[std::min(index, options.arity - 1)]);
+        } else {
+            children.push_back(next_symbol());
+        }
+    }
+}
+
+AtomPtr KbGenerator::next_fact() {
+    return next_expr(options.variables);
+}
+
+AtomPtr KbGenerator::next_rule() {
+    ExprAtomPtr pattern = std::static_pointer_cast<ExprAtom>(
+            next_expr(std::max(options.variables, 0.5)));
+    if (!pattern->has_variables()) {
+        pattern = pattern->with_child(pattern->get_children().size() - 1, variables[0]);
+    }
+    auto const& pattern_vars = pattern->get_variables();
+    std::vector<AtomPtr> templ{ next_symbol() };
+    while (templ.size() < options.arity) {
+        size_t index = static_cast<size_t>(uniform(random) * pattern_vars.size());
+        templ.push_back(pattern_vars[std::min(index, pattern_vars.size() - 1)]);
+    }
+    return E({ S("="), pattern, E(std::move(templ)) });
+}
+
+void KbGenerator::generate(AtomSink const& sink) {
+    for (size_t i = 0; i < options.facts; ++i) {
+        sink(next_fact());
+    }
+    for (size_t i = 0; i < options.rules; ++i) {
+        sink(next_rule());
+    }
+}
+
+void KbGenerator::generate(GroundingSpace& kb) {
+    generate([&kb](AtomPtr atom) -> void { kb.add_atom(atom); });
+}
+
+void KbGenerator::generate(std::ostream& out) {
+    generate([&out](AtomPtr atom) -> void { out << *atom << '\n'; });
+}
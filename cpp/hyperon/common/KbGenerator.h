@@ -0,0 +1,68 @@
+#ifndef KB_GENERATOR_H
+#define KB_GENERATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include <hyperon/GroundingSpace.h>
+
+// Generator of synthetic knowledge bases
+
+// Facts are expressions of the given arity, first child is a symbol and
+// other children are symbols, variables or nested expressions. Symbols are
+// taken from the vocabulary of s<rank> symbols with Zipfian distribution of
+// ranks: probability of the symbol is proportional to 1 / rank^skew, zero
+// skew gives uniform distribution. Rules have (= <pattern> <template>) form
+// where template reuses variables of the pattern. Generated knowledge base
+// depends on options only, so it can be reproduced by the seed.
+struct KbGeneratorOptions {
+    size_t facts = 1000;
+    size_t rules = 0;
+    size_t symbols = 1000;
+    double skew = 1.0;
+    // maximal depth of the expression, 1 means no nested expressions
+    size_t depth = 1;
+    // number of children of each expression
+    size_t arity = 3;
+    // probability of the child to be a nested expression when maximal depth
+    // is not reached
+    double nesting = 0.5;
+    // probability of the fact child to be a variable, rules patterns have at
+    // least one variable
+    double variables = 0.0;
+    uint64_t seed = 1;
+};
+
+class KbGenerator {
+public:
+    using AtomSink = std::function<void(AtomPtr)>;
+
+    KbGenerator(KbGeneratorOptions const& options);
+
+    AtomPtr next_fact();
+    AtomPtr next_rule();
+
+    // Generates facts and then rules
+    void generate(AtomSink const& sink);
+    void generate(GroundingSpace& kb);
+    // Writes knowledge base as text, one atom per line, it can be parsed
+    // by TextSpace
+    void generate(std::ostream& out);
+
+private:
+    AtomPtr next_symbol();
+    AtomPtr next_expr(double variables);
+
+    KbGeneratorOptions options;
+    std::mt19937_64 random;
+    std::uniform_real_distribution<double> uniform;
+    // cumulative distribution of the symbol ranks
+    std::vector<double> ranks;
+    std::vector<AtomPtr> symbols;
+    std::vector<AtomPtr> variables;
+};
+
+#endif /* KB_GENERATOR_H */
@@ -3,7 +3,9 @@
 
 #include "GroundedArithmetic.h"
 #include "GroundedLogic.h"
+#include "GroundedOperations.h"
 #include "Interpret.h"
 #include "Atomese.h"
+#include "KbGenerator.h"
 
 #endif /* HYPERON_COMMON_H */
@@ -5,5 +5,11 @@
 #include "SpaceAPI.h"
 #include "GroundingSpace.h"
 #include "TextSpace.h"
+#include "Tokenizer.h"
+#include "Serialization.h"
+#include "ImageSpace.h"
+#include "Tracer.h"
+#include "Profiler.h"
+#include "Metrics.h"
 
 #endif /* HYPERON_H */
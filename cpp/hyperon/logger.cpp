@@ -1,9 +1,11 @@
 #include "logger_priv.h"
 
-Logger::Level Logger::level = Logger::ERROR;
+#include <mutex>
 
-LoggerImpl clog::error(Logger::ERROR);
-LoggerImpl clog::info(Logger::INFO);
-LoggerImpl clog::debug(Logger::DEBUG);
-LoggerImpl clog::trace(Logger::TRACE);
+std::atomic<Logger::Level> Logger::level(Logger::ERROR);
 
+void write_log_record(std::string const& record) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::clog << record << std::flush;
+}
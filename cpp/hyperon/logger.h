@@ -1,6 +1,8 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include <atomic>
+
 class Logger {
 public:
 
@@ -12,16 +14,16 @@ public:
     };
 
     static void setLevel(Level level) {
-        Logger::level = level;
+        Logger::level.store(level, std::memory_order_relaxed);
     }
 
     static Level getLevel() {
-        return level;
+        return level.load(std::memory_order_relaxed);
     }
 
 private:
 
-    static Level level;
+    static std::atomic<Level> level;
 };
 
 #endif /* LOGGER_H */
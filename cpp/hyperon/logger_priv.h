@@ -3,46 +3,46 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 #include "logger.h"
 
-class LoggerImpl {
-public:
+// Messages above HYPERON_MAX_LOG_LEVEL are removed at compile time, it is
+// set by the HYPERON_MAX_LOG_LEVEL CMake option.
+#ifndef HYPERON_MAX_LOG_LEVEL
+#define HYPERON_MAX_LOG_LEVEL Logger::TRACE
+#endif
 
-    template<typename T>
-    LoggerImpl& operator<<(const T& data) {
-        if (level <= Logger::getLevel()) {
-            std::clog << data;
-        }
-        return *this;
-    }
+inline bool is_log_enabled(Logger::Level level) {
+    return level <= HYPERON_MAX_LOG_LEVEL && level <= Logger::getLevel();
+}
 
-    LoggerImpl& operator<<(std::ostream& (&endl)(std::ostream& os)) {
-        if (level <= Logger::getLevel()) {
-            std::clog << endl;
-        }
-        return *this;
-    }
+void write_log_record(std::string const& record);
 
-    LoggerImpl(Logger::Level level) : level(level) { }
+// Log record is collected in a local buffer and written into std::clog as a
+// whole when the record is destroyed, so records written from different
+// threads are not mixed.
+class LogRecord {
+public:
 
-private:
+    ~LogRecord() { write_log_record(buffer.str()); }
 
-    Logger::Level level;
-};
+    std::ostream& stream() { return buffer; }
 
-namespace clog {
-
-extern LoggerImpl error;
-extern LoggerImpl info;
-extern LoggerImpl debug;
-extern LoggerImpl trace;
+private:
 
+    std::ostringstream buffer;
 };
 
-#define LOG_ERROR (clog::error << "ERROR: " << __func__ << ": ")
-#define LOG_INFO (clog::info << "INFO:  " << __func__ << ": ")
-#define LOG_DEBUG (clog::debug << "DEBUG: " << __func__ << ": ")
-#define LOG_TRACE (clog::trace << "TRACE: " << __func__ << ": ")
+// Arguments of the message are evaluated only when the level is enabled.
+// The if-else form makes the macro safe to use in unbraced if statements.
+#define LOG_AT(level, prefix) \
+    if (!is_log_enabled(level)) ; \
+    else LogRecord().stream() << prefix << __func__ << ": "
+
+#define LOG_ERROR LOG_AT(Logger::ERROR, "ERROR: ")
+#define LOG_INFO LOG_AT(Logger::INFO, "INFO:  ")
+#define LOG_DEBUG LOG_AT(Logger::DEBUG, "DEBUG: ")
+#define LOG_TRACE LOG_AT(Logger::TRACE, "TRACE: ")
 
 #endif /* LOGGER_PRIV_H */
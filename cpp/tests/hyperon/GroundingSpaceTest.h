@@ -1,5 +1,10 @@
 #include <cxxtest/TestSuite.h>
 
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
 #include <hyperon/hyperon.h>
 #include <hyperon/common/common.h>
 
@@ -15,6 +20,14 @@ void add_factorial_definition(GroundingSpace& kb) {
                                 V("n") }) }) }));
 }
 
+AtomPtr deep_list(int depth, AtomPtr tail) {
+    AtomPtr list = tail;
+    for (int i = 0; i < depth; ++i) {
+        list = E({ S("::"), S("a"), list });
+    }
+    return list;
+}
+
 class GroundingSpaceTest : public CxxTest::TestSuite {
 public:
 
@@ -23,11 +36,109 @@ public:
         TS_ASSERT_EQUALS(atom->to_string(), "(= $a 0)");
     }
 
+    void test_expr_atom_write_to() {
+        std::ostringstream out;
+        out << *E({S("="), E({MUL, Int(2), V("a")}), E({}), String("b")});
+        TS_ASSERT_EQUALS(out.str(), "(= (* 2 $a) () \"b\")");
+    }
+
+    void test_deep_expr_atom_to_string() {
+        std::string str = deep_list(100000, S("nil"))->to_string();
+        TS_ASSERT_EQUALS(str.size(), 100000 * 7 + 3);
+        TS_ASSERT_EQUALS(str.substr(0, 12), "(:: a (:: a ");
+        TS_ASSERT_EQUALS(str.substr(100000 * 6, 6), "nil)))");
+    }
+
+    void test_space_write_to_file() {
+        GroundingSpace space;
+        space.add_atom(E({S("="), V("a"), S("0")}));
+        space.add_atom(S("b"));
+        char path[] = "/tmp/GroundingSpaceTestXXXXXX";
+        int fd = mkstemp(path);
+        TS_ASSERT(fd != -1);
+        close(fd);
+
+        space.write_to_file(path);
+
+        std::ifstream in(path);
+        std::stringstream text;
+        text << in.rdbuf();
+        std::remove(path);
+        TS_ASSERT_EQUALS(text.str(), "<(= $a 0), b>");
+        TS_ASSERT_EQUALS(text.str(), space.to_string());
+    }
+
+    void test_space_atom_count() {
+        GroundingSpace space({ S("a"), E({ S("b"), V("x") }) });
+        space.add_atom(E({}));
+        space.add_atoms({ V("y"), Int(1) });
+
+        TS_ASSERT_EQUALS(space.get_atom_count(Atom::SYMBOL), 1);
+        TS_ASSERT_EQUALS(space.get_atom_count(Atom::EXPR), 2);
+        TS_ASSERT_EQUALS(space.get_atom_count(Atom::VARIABLE), 1);
+        TS_ASSERT_EQUALS(space.get_atom_count(Atom::GROUNDED), 1);
+    }
+
+    void test_space_memory_usage() {
+        AtomPtr shared = E({ S("b"), V("x") });
+        std::string long_name(100, 'c');
+        GroundingSpace space({ E({ S("a"), shared, shared }), S(long_name), Int(1) });
+
+        MemoryUsage usage = space.get_memory_usage();
+
+        TS_ASSERT_EQUALS(usage.atoms[Atom::EXPR], 3);
+        TS_ASSERT_EQUALS(usage.unique_atoms[Atom::EXPR], 2);
+        TS_ASSERT_EQUALS(usage.atoms[Atom::SYMBOL], 3);
+        TS_ASSERT_EQUALS(usage.unique_atoms[Atom::SYMBOL], 3);
+        TS_ASSERT_EQUALS(usage.atoms[Atom::VARIABLE], 1);
+        TS_ASSERT_EQUALS(usage.unique_atoms[Atom::VARIABLE], 1);
+        TS_ASSERT_EQUALS(usage.unique_atoms[Atom::GROUNDED], 1);
+        TS_ASSERT_EQUALS(usage.shared_atoms, 1);
+        TS_ASSERT(usage.string_bytes > long_name.size());
+        TS_ASSERT(usage.children_bytes >= 5 * sizeof(AtomPtr));
+        TS_ASSERT(usage.index_bytes >= 3 * sizeof(AtomPtr));
+        TS_ASSERT(usage.atom_bytes >= 2 * sizeof(ExprAtom) + 3 * sizeof(SymbolAtom));
+        TS_ASSERT_EQUALS(usage.get_total_bytes(), usage.atom_bytes +
+                usage.string_bytes + usage.children_bytes + usage.index_bytes);
+    }
+
     void test_expr_atom_equals() {
         AtomPtr atom = E({S("="), V("a"), S("0")});
         TS_ASSERT(*atom == *E({S("="), V("a"), S("0")}));
     }
 
+    void test_expr_atom_with_child() {
+        ExprAtomPtr expr = E({S("="), E({S("a")}), S("0")});
+        ExprAtomPtr copy = expr->with_child(2, S("1"));
+
+        TS_ASSERT(*expr == *E({S("="), E({S("a")}), S("0")}));
+        TS_ASSERT(*copy == *E({S("="), E({S("a")}), S("1")}));
+        TS_ASSERT(expr->get_children()[1] == copy->get_children()[1]);
+    }
+
+    void test_expr_atom_variables() {
+        ExprAtomPtr expr = E({S("="), E({V("b"), V("a")}), V("b")});
+
+        TS_ASSERT(expr->has_variables());
+        TS_ASSERT_EQUALS(expr->get_variables().size(), 2);
+        TS_ASSERT(*expr->get_variables()[0] == *V("a"));
+        TS_ASSERT(*expr->get_variables()[1] == *V("b"));
+        TS_ASSERT(!E({S("="), E({S("a")})})->has_variables());
+    }
+
+    void test_expr_atom_variables_of_deep_expression() {
+        AtomPtr list = S("nil");
+        for (size_t i = 0; i < 10000; ++i) {
+            list = E({S("cons"), V("x" + std::to_string(i % 3)), list});
+        }
+        ExprAtom const& expr = static_cast<ExprAtom const&>(*list);
+
+        TS_ASSERT_EQUALS(expr.get_variable_mask(),
+                V("x0")->get_mask() | V("x1")->get_mask() | V("x2")->get_mask());
+        TS_ASSERT_EQUALS(expr.get_variables().size(), 3);
+        TS_ASSERT(*expr.get_variables()[2] == *V("x2"));
+    }
+
     void test_match_function_definition() {
         GroundingSpace kb;
         kb.add_atom(E({ S(":-"), E({ S("fact"), S("0") }), S("1") }));
@@ -64,6 +175,121 @@ public:
         TS_ASSERT(expected == result);
     }
 
+    void test_add_from_grounding_space() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("isa"), S("a"), S("b") }));
+        GroundingSpace other;
+        other.add_atom(S("c"));
+
+        other.add_from_space(kb);
+        other.add_from_space(other);
+
+        GroundingSpace expected;
+        expected.add_atom(S("c"));
+        expected.add_atom(E({ S("isa"), S("a"), S("b") }));
+        expected.add_atom(S("c"));
+        expected.add_atom(E({ S("isa"), S("a"), S("b") }));
+        TS_ASSERT(expected == other);
+        TS_ASSERT_EQUALS(other.get_content()[1], kb.get_content()[0]);
+    }
+
+    void test_copy_shares_content_until_change() {
+        GroundingSpace kb;
+        kb.add_atom(S("a"));
+        GroundingSpace copy(kb);
+
+        TS_ASSERT_EQUALS(&copy.get_content(), &kb.get_content());
+        kb.add_atom(S("b"));
+        copy.add_atom(S("c"));
+
+        TS_ASSERT_EQUALS(kb, GroundingSpace({ S("a"), S("b") }));
+        TS_ASSERT_EQUALS(copy, GroundingSpace({ S("a"), S("c") }));
+        TS_ASSERT_EQUALS(copy.get_atom_count(Atom::SYMBOL), 2);
+    }
+
+    void test_match_iterator() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("isa"), S("kitchen-lamp"), S("lamp") }));
+        kb.add_atom(E({ S("isa"), S("fridge"), S("device") }));
+        kb.add_atom(E({ S("isa"), S("bedroom-lamp"), S("lamp") }));
+        MatchIterator matches = kb.match_iterator(E({ S("isa"), V("x"), S("lamp") }));
+        Bindings bindings;
+
+        TS_ASSERT(matches.next(bindings));
+        TS_ASSERT(*S("kitchen-lamp") == *bindings[V("x")]);
+        kb.add_atom(E({ S("isa"), S("desk-lamp"), S("lamp") }));
+        TS_ASSERT(matches.next(bindings));
+        TS_ASSERT(*S("bedroom-lamp") == *bindings[V("x")]);
+        TS_ASSERT(!matches.next(bindings));
+        TS_ASSERT_EQUALS(kb.get_content().size(), 4);
+    }
+
+    void test_match_shares_ground_subexpressions() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("isa"), S("kitchen-lamp"), S("lamp") }));
+        GroundingSpace pattern;
+        pattern.add_atom(E({ S("isa"), V("x"), S("lamp") }));
+        AtomPtr ground = E({ S("is"), S("lamp") });
+        GroundingSpace templ;
+        templ.add_atom(E({ V("x"), ground }));
+        templ.add_atom(ground);
+
+        GroundingSpace result;
+        kb.match(pattern, templ, result);
+
+        ExprAtomPtr applied = std::static_pointer_cast<ExprAtom>(result.get_content()[0]);
+        TS_ASSERT(*applied == *E({ S("kitchen-lamp"), ground }));
+        TS_ASSERT(applied->get_children()[1] == ground);
+        TS_ASSERT(result.get_content()[1] == ground);
+    }
+
+    void test_unify_variable_bound_through_other_variable() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("="), E({ S("f"), V("a"), S("5") }), V("a") }));
+
+        std::vector<UnificationResult> results =
+            kb.unify(E({ S("="), E({ S("f"), V("y"), V("y") }), V("X") }));
+
+        TS_ASSERT_EQUALS(results.size(), 1);
+        TS_ASSERT(*S("5") == *results[0].b_bindings.at(V("X")));
+        TS_ASSERT(*S("5") == *results[0].b_bindings.at(V("y")));
+    }
+
+    void test_unify_occurs_check() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("eq"), V("x"), V("x") }));
+        AtomPtr atom = E({ S("eq"), E({ S("S"), V("n") }), V("n") });
+
+        TS_ASSERT_EQUALS(kb.unify(atom, false).size(), 1);
+        TS_ASSERT_EQUALS(kb.unify(atom, true).size(), 0);
+    }
+
+    void test_match_deep_expression() {
+        GroundingSpace kb;
+        kb.add_atom(deep_list(100000, S("nil")));
+        GroundingSpace pattern;
+        pattern.add_atom(deep_list(100000, V("tail")));
+        GroundingSpace templ;
+        templ.add_atom(E({ S("tail"), deep_list(100000, V("tail")) }));
+
+        GroundingSpace result;
+        kb.match(pattern, templ, result);
+
+        GroundingSpace expected;
+        expected.add_atom(E({ S("tail"), deep_list(100000, S("nil")) }));
+        TS_ASSERT(expected == result);
+    }
+
+    void test_unify_deep_expression() {
+        GroundingSpace kb;
+        kb.add_atom(deep_list(100000, V("tail")));
+
+        std::vector<UnificationResult> results = kb.unify(deep_list(100000, S("nil")));
+
+        TS_ASSERT_EQUALS(results.size(), 1);
+        TS_ASSERT(*S("nil") == *results[0].a_bindings.at(V("tail")));
+    }
+
     void test_interpret_plain_expr() {
         GroundingSpace kb;
         add_factorial_definition(kb);
@@ -90,6 +316,19 @@ public:
 
     }
 
+    void test_interpret_deep_expression() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("="), E({ S("len"), S("nil") }), Int(0) }));
+        kb.add_atom(E({ S("="), E({ S("len"), E({ S("::"), V("x"), V("xs") }) }),
+                    E({ ADD, Int(1), E({ S("len"), V("xs") }) }) }));
+        GroundingSpace target;
+        target.add_atom(E({ S("len"), deep_list(1000, S("nil")) }));
+
+        AtomPtr result = interpret_until_result(target, kb);
+
+        TS_ASSERT(*Int(1000) == *result);
+    }
+
     void test_match_variable_in_target() {
         GroundingSpace kb;
         kb.add_atom(E({ S("="), E({ S("isa"), S("Fred"), S("frog") }),
@@ -0,0 +1,148 @@
+#include <cxxtest/TestSuite.h>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+std::string write_image(std::vector<AtomPtr> const& atoms) {
+    char path[] = "/tmp/ImageSpaceTestXXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    std::ofstream out(path, std::ios::binary);
+    ImageSpace::write(atoms, out);
+    return path;
+}
+
+std::string bindings_to_string(std::vector<Bindings> const& results) {
+    std::string str;
+    for (auto const& bindings : results) {
+        str += "{";
+        for (auto const& binding : bindings) {
+            str += " " + binding.first->to_string() + "=" + binding.second->to_string();
+        }
+        str += " }";
+    }
+    return str;
+}
+
+std::string unifications_to_string(std::vector<UnificationResult> const& results) {
+    std::string str;
+    for (auto const& result : results) {
+        str += bindings_to_string({ result.a_bindings, result.b_bindings }) + "[";
+        for (auto const& unification : result.unifications) {
+            str += " " + unification.a->to_string() + "~" + unification.b->to_string();
+        }
+        str += " ]";
+    }
+    return str;
+}
+
+class ImageSpaceTest : public CxxTest::TestSuite {
+public:
+
+    std::vector<AtomPtr> atoms;
+    std::string path;
+
+    void setUp() {
+        atoms = {
+            E({ S("="), E({ S("if"), TRUE, V("then"), V("else") }), V("then") }),
+            E({ S("="), E({ S("if"), FALSE, V("then"), V("else") }), V("else") }),
+            E({ S("="), E({ S("fact"), V("n") }),
+                E({ S("if"), E({ EQ, Int(0), V("n") }), Int(1),
+                    E({ MUL, E({ S("fact"), E({ SUB, V("n"), Int(1) }) }), V("n") }) }) }),
+            E({ S("="), E({ S("f"), S("a") }), S("b") }),
+            E({ S("="), S("c"), S("d") }),
+            E({ S("="), E({ S("f"), S("a"), S("b") }), S("c") }),
+            E({ S("isa"), S("Fred"), S("frog") }),
+            E({ S("isa"), V("x"), S("animal") }),
+            E({ V("r"), S("Fred"), S("Sam") }),
+            E({ E({ S("f") }), S("a") }),
+            S("a"),
+            E({}),
+        };
+        path = write_image(atoms);
+    }
+
+    void tearDown() {
+        std::remove(path.c_str());
+    }
+
+    void test_get_atoms() {
+        ImageSpace image(path);
+
+        TS_ASSERT_EQUALS(image.size(), atoms.size());
+        GroundingSpace space;
+        space.add_from_space(image);
+        TS_ASSERT_EQUALS(space, GroundingSpace(atoms));
+        TS_ASSERT(*atoms[3] == *image.get_atom(3));
+    }
+
+    void test_match_and_unify_as_grounding_space() {
+        ImageSpace image(path);
+        GroundingSpace space(atoms);
+        std::vector<AtomPtr> queries = {
+            E({ S("="), E({ S("f"), S("a") }), V("X") }),
+            E({ S("="), E({ S("f"), V("x") }), V("X") }),
+            E({ S("="), S("c"), V("X") }),
+            E({ S("="), E({ S("fact"), Int(3) }), V("X") }),
+            E({ S("="), E({ S("if"), V("c"), S("a"), S("b") }), V("X") }),
+            E({ S("isa"), S("Fred"), V("y") }),
+            E({ S("isa"), E({ S("g"), S("Fred") }), V("y") }),
+            E({ S("likes"), S("Fred"), S("Sam") }),
+            E({ V("h"), S("Fred"), V("y") }),
+            E({ S("=") }),
+            V("x"),
+            S("a"),
+        };
+
+        for (auto const& query : queries) {
+            TS_ASSERT_EQUALS(bindings_to_string(image.match(query)),
+                    bindings_to_string(space.match(query)));
+            TS_ASSERT_EQUALS(unifications_to_string(image.unify(query)),
+                    unifications_to_string(space.unify(query)));
+        }
+    }
+
+    void test_match_from_many_threads() {
+        ImageSpace image(path);
+        GroundingSpace space(atoms);
+        AtomPtr query = E({ S("="), E({ S("f"), V("x") }), V("X") });
+        std::string expected = unifications_to_string(space.unify(query));
+        std::vector<std::string> results(4);
+
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < results.size(); ++i) {
+            threads.emplace_back([&image, &query, &results, i]() -> void {
+                    results[i] = unifications_to_string(image.unify(query));
+                });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (auto const& result : results) {
+            TS_ASSERT_EQUALS(result, expected);
+        }
+    }
+
+    void test_interpret_with_image_as_knowledge_base() {
+        std::string rules_path = write_image(std::vector<AtomPtr>(atoms.begin(), atoms.begin() + 3));
+        ImageSpace image(rules_path);
+        GroundingSpace target;
+        target.add_atom(E({ S("fact"), Int(5) }));
+
+        AtomPtr result = interpret_until_result(target, image);
+        std::remove(rules_path.c_str());
+
+        TS_ASSERT(*Int(120) == *result);
+    }
+
+    void test_open_not_an_image() {
+        std::ofstream(path) << "(not an image)";
+        TS_ASSERT_THROWS(ImageSpace image(path), std::runtime_error);
+    }
+};
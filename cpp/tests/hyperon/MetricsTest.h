@@ -0,0 +1,128 @@
+#include <cxxtest/TestSuite.h>
+
+#include <thread>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+uint64_t timed_calls(OperationMetrics const& metrics) {
+    uint64_t calls = 0;
+    for (auto count : metrics.latency) {
+        calls += count;
+    }
+    return calls;
+}
+
+class MetricsTest : public CxxTest::TestSuite {
+public:
+
+    void setUp() {
+        Metrics::reset();
+    }
+
+    void test_count_space_operations() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("isa"), S("a"), S("b") }));
+        kb.add_atoms({ E({ S("isa"), S("c"), S("d") }), E({ S("isa"), S("e"), S("b") }) });
+
+        kb.match(E({ S("isa"), V("x"), S("b") }));
+        kb.unify(E({ S("isa"), S("c"), V("y") }));
+
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        OperationMetrics const& match = snapshot.operations[MetricsSnapshot::MATCH];
+        OperationMetrics const& unify = snapshot.operations[MetricsSnapshot::UNIFY];
+        OperationMetrics const& add_atom = snapshot.operations[MetricsSnapshot::ADD_ATOM];
+        TS_ASSERT_EQUALS(add_atom.calls, 2);
+        TS_ASSERT_EQUALS(snapshot.atoms_added, 3);
+        TS_ASSERT_EQUALS(timed_calls(add_atom), 0);
+        TS_ASSERT_EQUALS(match.calls, 1);
+        TS_ASSERT_EQUALS(timed_calls(match), 1);
+        TS_ASSERT_EQUALS(unify.calls, 1);
+        TS_ASSERT_EQUALS(timed_calls(unify), 1);
+        TS_ASSERT_EQUALS(snapshot.candidates_examined, 6);
+        TS_ASSERT_EQUALS(snapshot.candidates_matched, 3);
+    }
+
+    void test_count_interpret_steps() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("="), E({ S("f"), V("x") }), E({ S("g"), V("x") }) }));
+        GroundingSpace target;
+        target.add_atom(E({ S("f"), S("a") }));
+        Metrics::reset();
+
+        AtomPtr result = interpret_until_result(target, kb);
+
+        TS_ASSERT(*E({ S("g"), S("a") }) == *result);
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        OperationMetrics const& step = snapshot.operations[MetricsSnapshot::INTERPRET_STEP];
+        TS_ASSERT(step.calls > 0);
+        TS_ASSERT_EQUALS(timed_calls(step), step.calls);
+        TS_ASSERT(snapshot.operations[MetricsSnapshot::UNIFY].calls > 0);
+    }
+
+    void test_dont_count_scratch_spaces() {
+        GroundingSpace scratch = GroundingSpace::scratch();
+
+        scratch.add_atom(S("a"));
+        scratch.add_atoms({ S("b"), S("c") });
+
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        TS_ASSERT_EQUALS(snapshot.operations[MetricsSnapshot::ADD_ATOM].calls, 0);
+        TS_ASSERT_EQUALS(snapshot.atoms_added, 0);
+        TS_ASSERT_EQUALS(scratch.get_content().size(), 3);
+    }
+
+    void test_count_parsed_atoms_once() {
+        TextSpace text;
+        text.add_string("(isa a b) (isa c d) (isa e f)");
+        GroundingSpace space;
+        Metrics::reset();
+
+        space.add_from_space(text);
+
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        TS_ASSERT_EQUALS(snapshot.operations[MetricsSnapshot::ADD_ATOM].calls, 1);
+        TS_ASSERT_EQUALS(snapshot.atoms_added, 3);
+    }
+
+    void test_reset() {
+        GroundingSpace kb;
+        kb.add_atom(S("a"));
+
+        Metrics::reset();
+
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        TS_ASSERT_EQUALS(snapshot.operations[MetricsSnapshot::ADD_ATOM].calls, 0);
+        kb.add_atom(S("b"));
+        snapshot = Metrics::get_snapshot();
+        TS_ASSERT_EQUALS(snapshot.operations[MetricsSnapshot::ADD_ATOM].calls, 1);
+    }
+
+    void test_aggregate_threads() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("isa"), S("a"), S("b") }));
+        std::thread running([&kb]() -> void {
+                kb.match(E({ S("isa"), V("x"), S("b") }));
+            });
+        running.join();
+
+        kb.match(E({ S("isa"), V("x"), S("b") }));
+
+        MetricsSnapshot snapshot = Metrics::get_snapshot();
+        TS_ASSERT_EQUALS(snapshot.operations[MetricsSnapshot::MATCH].calls, 2);
+        TS_ASSERT_EQUALS(snapshot.candidates_matched, 2);
+    }
+
+    void test_get_percentile() {
+        OperationMetrics metrics{};
+        metrics.latency[0] = 50;
+        metrics.latency[4] = 40;
+        metrics.latency[10] = 10;
+
+        TS_ASSERT_EQUALS(metrics.get_percentile(0.0), 0);
+        TS_ASSERT_EQUALS(metrics.get_percentile(0.5), 15);
+        TS_ASSERT_EQUALS(metrics.get_percentile(0.9), 1023);
+        TS_ASSERT_EQUALS(metrics.get_percentile(1.0), 1023);
+        TS_ASSERT_EQUALS(OperationMetrics{}.get_percentile(0.5), 0);
+    }
+};
@@ -0,0 +1,111 @@
+#include <cxxtest/TestSuite.h>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+RuleProfile const* find_rule(std::vector<RuleProfile> const& rules, AtomPtr rule) {
+    for (auto const& profile : rules) {
+        if (*profile.rule == *rule) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+GroundedProfile const* find_grounded(std::vector<GroundedProfile> const& grounded, AtomPtr atom) {
+    for (auto const& profile : grounded) {
+        if (profile.atom == atom) {
+            return &profile;
+        }
+    }
+    return nullptr;
+}
+
+class ProfilerTest : public CxxTest::TestSuite {
+public:
+
+    void setUp() {
+        Profiler::clear();
+        Profiler::enable();
+    }
+
+    void tearDown() {
+        Profiler::disable();
+        Profiler::clear();
+    }
+
+    void test_profile_rules_and_grounded_atoms() {
+        AtomPtr if_true = E({ S("="), E({ S("if"), TRUE, V("then"), V("else") }), V("then") });
+        AtomPtr if_false = E({ S("="), E({ S("if"), FALSE, V("then"), V("else") }), V("else") });
+        AtomPtr fact = E({ S("="),
+                E({ S("fact"), V("n") }),
+                E({ S("if"), E({ EQ, Int(0), V("n") }),
+                        Int(1),
+                        E({ MUL,
+                                E({ S("fact"), E({ SUB, V("n"), Int(1) }) }),
+                                V("n") }) }) });
+        GroundingSpace kb({ if_true, if_false, fact });
+        GroundingSpace target;
+        target.add_atom(E({ S("fact"), Int(3) }));
+
+        AtomPtr result = interpret_until_result(target, kb);
+
+        TS_ASSERT(*Int(6) == *result);
+        std::vector<RuleProfile> rules = Profiler::get_rules();
+        TS_ASSERT_EQUALS(rules.size(), 3);
+        RuleProfile const* fact_profile = find_rule(rules, fact);
+        TS_ASSERT(fact_profile);
+        TS_ASSERT_EQUALS(fact_profile->unifications, 4);
+        TS_ASSERT_EQUALS(fact_profile->results, 4);
+        TS_ASSERT(fact_profile->tests >= fact_profile->unifications);
+        TS_ASSERT(find_rule(rules, if_true)->results > 0);
+        TS_ASSERT(find_rule(rules, if_false)->results > 0);
+        for (size_t i = 1; i < rules.size(); ++i) {
+            TS_ASSERT(rules[i - 1].time >= rules[i].time);
+        }
+
+        std::vector<GroundedProfile> grounded = Profiler::get_grounded();
+        TS_ASSERT(find_grounded(grounded, EQ)->calls >= 4);
+        TS_ASSERT(find_grounded(grounded, SUB)->calls >= 3);
+        TS_ASSERT_EQUALS(find_grounded(grounded, MUL)->calls, 3);
+        TS_ASSERT_EQUALS(find_grounded(grounded, MUL)->results, 3);
+        TS_ASSERT_EQUALS(find_grounded(grounded, MUL)->exceptions, 0);
+    }
+
+    void test_profile_grounded_atom_exceptions() {
+        GroundingSpace kb;
+        GroundingSpace target;
+        target.add_atom(E({ ADD, S("a"), Int(1) }));
+
+        interpret_until_result(target, kb);
+
+        GroundedProfile const* add = find_grounded(Profiler::get_grounded(), ADD);
+        TS_ASSERT(add);
+        TS_ASSERT_EQUALS(add->calls, 1);
+        TS_ASSERT_EQUALS(add->exceptions, 1);
+        TS_ASSERT_EQUALS(add->results, 0);
+    }
+
+    void test_disabled_profiler_collects_nothing() {
+        Profiler::disable();
+        GroundingSpace kb({ E({ S("="), S("a"), S("b") }) });
+
+        kb.unify(E({ S("="), S("a"), V("X") }));
+
+        TS_ASSERT(Profiler::get_rules().empty());
+    }
+
+    void test_report() {
+        GroundingSpace kb({ E({ S("="), E({ S("f"), V("x") }), E({ ADD, V("x"), Int(1) }) }) });
+        GroundingSpace target;
+        target.add_atom(E({ S("f"), Int(1) }));
+        interpret_until_result(target, kb);
+
+        std::string report = Profiler::get_report();
+
+        TS_ASSERT(report.find("rules:\n") == 0);
+        TS_ASSERT(report.find("  (= (f $x) (+ $x 1))\n") != std::string::npos);
+        TS_ASSERT(report.find("grounded atoms:\n") != std::string::npos);
+        TS_ASSERT(report.find("  +\n") != std::string::npos);
+    }
+};
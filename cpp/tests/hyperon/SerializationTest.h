@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+class UnknownAtom : public GroundedAtom {
+public:
+    void execute(GroundingSpace const& args, GroundingSpace& result) const override { }
+    bool operator==(Atom const& other) const override { return this == &other; }
+    std::string to_string() const override { return "unknown"; }
+};
+
+GroundingSpace serialize_and_deserialize(GroundingSpace const& space) {
+    std::stringstream data;
+    space.serialize(data);
+    GroundingSpace result;
+    result.deserialize(data);
+    return result;
+}
+
+class SerializationTest : public CxxTest::TestSuite {
+public:
+
+    void test_serialize_symbols_variables_and_expressions() {
+        GroundingSpace space;
+        space.add_atom(S("a"));
+        space.add_atom(V("x"));
+        space.add_atom(E({ S("="), E({ S("f"), V("x"), E({}) }), E({ S("g"), V("x"), S("a") }) }));
+
+        TS_ASSERT_EQUALS(serialize_and_deserialize(space), space);
+    }
+
+    void test_deserialize_symbol_as_same_instance() {
+        GroundingSpace space;
+        space.add_atom(E({ S("a"), S("a") }));
+
+        GroundingSpace result = serialize_and_deserialize(space);
+
+        ExprAtom const* expr = static_cast<ExprAtom const*>(result.get_content()[0].get());
+        TS_ASSERT_EQUALS(expr->get_children()[0], expr->get_children()[1]);
+    }
+
+    void test_serialize_grounded_atoms() {
+        GroundingSpace space;
+        space.add_atom(E({ ADD, Int(-1), Float(2.5) }));
+        space.add_atom(E({ CONCAT, String("a b"), String("") }));
+        space.add_atom(E({ IF, E({ EQ, TRUE, FALSE }), SUB, MUL }));
+        space.add_atom(E({ IFMATCH, V("x"), S("a"), DIV }));
+
+        GroundingSpace result = serialize_and_deserialize(space);
+
+        TS_ASSERT_EQUALS(result, space);
+        ExprAtom const* expr = static_cast<ExprAtom const*>(result.get_content()[0].get());
+        TS_ASSERT_EQUALS(expr->get_children()[0], ADD);
+    }
+
+    void test_serialize_deep_expression() {
+        AtomPtr list = S("nil");
+        for (int i = 0; i < 100000; ++i) {
+            list = E({ S("::"), Int(i), list });
+        }
+        GroundingSpace space;
+        space.add_atom(list);
+
+        TS_ASSERT_EQUALS(serialize_and_deserialize(space), space);
+    }
+
+    void test_serialize_unknown_grounded_atom() {
+        GroundingSpace space;
+        space.add_atom(std::make_shared<UnknownAtom>());
+
+        std::stringstream data;
+        TS_ASSERT_THROWS(space.serialize(data), std::runtime_error);
+    }
+
+    void test_deserialize_truncated_data() {
+        GroundingSpace space;
+        space.add_atom(E({ S("a"), E({ S("b"), Int(1) }) }));
+        std::stringstream data;
+        space.serialize(data);
+        std::string bytes = data.str();
+
+        for (size_t size = 0; size < bytes.size(); ++size) {
+            std::stringstream truncated(bytes.substr(0, size));
+            GroundingSpace result;
+            TS_ASSERT_THROWS(result.deserialize(truncated), std::runtime_error);
+        }
+    }
+
+    void test_deserialize_incorrect_table_sizes() {
+        // magic, version and huge size of the table
+        std::string header("HYPA\x01", 5);
+        std::string huge("\xff\xff\xff\xff\xff\xff\xff\xff\x3f", 9);
+        std::vector<std::string> inputs = {
+            header + huge,
+            header + std::string("\x00", 1) + huge,
+            header + std::string("\x00\x00", 2) + huge + std::string(16, '\0'),
+        };
+
+        for (auto const& input : inputs) {
+            std::stringstream data(input);
+            GroundingSpace result;
+            TS_ASSERT_THROWS(result.deserialize(data), std::runtime_error);
+        }
+    }
+};
@@ -1,5 +1,11 @@
 #include <cxxtest/TestSuite.h>
 
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
 #include <hyperon/hyperon.h>
 
 class FloatAtom : public ValueAtom<float> {
@@ -9,6 +15,26 @@ public:
     std::string to_string() const override { return std::to_string(get()); }
 };
 
+std::string many_expressions_program(int count) {
+    std::string program;
+    for (int i = 0; i < count; ++i) {
+        program += "(= (f " + std::to_string(i) + ")\n  (g $x\n    (h " +
+            std::to_string(i) + ")))\n";
+    }
+    return program;
+}
+
+// Space which keeps atoms as text lines
+class LinesSpace : public SpaceAPI {
+public:
+    void add_native(const SpaceAPI* other) override {
+        throw std::logic_error("Method is not implemented");
+    }
+    std::string get_type() const override { return "LinesSpace"; }
+
+    std::vector<std::string> lines;
+};
+
 class TextSpaceTest : public CxxTest::TestSuite {
 public:
 
@@ -48,6 +74,163 @@ public:
         TS_ASSERT_EQUALS(space, expected);
     }
 
+    void test_parse_deep_expression() {
+        int depth = 100000;
+        std::string program;
+        for (int i = 0; i < depth; ++i) {
+            program += "(:: a ";
+        }
+        program += "nil" + std::string(depth, ')');
+        TextSpace text;
+        text.add_string(program);
+
+        GroundingSpace space;
+        space.add_from_space(text);
+
+        AtomPtr list = S("nil");
+        for (int i = 0; i < depth; ++i) {
+            list = E({ S("::"), S("a"), list });
+        }
+        GroundingSpace expected;
+        expected.add_atom(list);
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_unexpected_right_bracket() {
+        TextSpace text;
+        text.add_string("(a))");
+
+        GroundingSpace space;
+        TS_ASSERT_THROWS(space.add_from_space(text), std::runtime_error);
+    }
+
+    void test_parse_stream() {
+        std::string program = many_expressions_program(10000);
+        TextSpace text;
+        text.add_string(program);
+        GroundingSpace expected;
+        expected.add_from_space(text);
+
+        std::istringstream in(program);
+        GroundingSpace space;
+        text.parse(in, [&space](AtomPtr atom) -> void { space.add_atom(atom); });
+
+        TS_ASSERT_EQUALS(space.get_content().size(), 10000);
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_stream_with_incomplete_expression() {
+        std::istringstream in("(a b)\n(c");
+        TextSpace text;
+        GroundingSpace space;
+        TS_ASSERT_THROWS(text.parse(in, [&space](AtomPtr atom) -> void { space.add_atom(atom); }),
+                std::runtime_error);
+    }
+
+    void test_parse_file() {
+        char path[] = "/tmp/TextSpaceTestXXXXXX";
+        int fd = mkstemp(path);
+        TS_ASSERT(fd != -1);
+        close(fd);
+        std::string program = many_expressions_program(1000);
+        std::ofstream(path) << program;
+        TextSpace text;
+        text.add_file(path);
+
+        GroundingSpace space;
+        space.add_from_space(text);
+        std::remove(path);
+
+        TextSpace expected_text;
+        expected_text.add_string(program);
+        GroundingSpace expected;
+        expected.add_from_space(expected_text);
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_in_parallel() {
+        std::string program = many_expressions_program(20000) +
+            "(say 'quoted ) bracket')\n" + many_expressions_program(20000);
+        TextSpace text;
+        text.register_token(std::string("'[^']*'"),
+                [](std::string token) -> AtomPtr { return S(token); });
+        text.add_string(program);
+        GroundingSpace expected;
+        expected.add_from_space(text);
+
+        text.set_threads(4);
+        GroundingSpace space;
+        space.add_from_space(text);
+
+        TS_ASSERT_EQUALS(space.get_content().size(), 40001);
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_in_parallel_quoted_strings_with_brackets() {
+        std::string program;
+        for (int i = 0; i < 20000; ++i) {
+            program += "(say \"a ) \\\" ( b\" " + std::to_string(i) + ")\n"
+                "(say 'c \" (d' \"e\\\\\")\n";
+        }
+        std::atomic<int> strings(0);
+        auto constr = [&strings](std::string token) -> AtomPtr {
+            ++strings;
+            return S(token);
+        };
+        TextSpace text;
+        text.register_token(std::string("\"([^\"\\\\]|\\\\.)*\""), constr);
+        text.register_token(std::string("'[^']*'"), constr);
+        text.add_string(program);
+        GroundingSpace expected;
+        expected.add_from_space(text);
+        strings = 0;
+
+        text.set_threads(4);
+        GroundingSpace space;
+        space.add_from_space(text);
+
+        TS_ASSERT_EQUALS(strings, 60000);
+        TS_ASSERT_EQUALS(space.get_content().size(), 40000);
+        TS_ASSERT(*space.get_content()[1] == *E({ S("say"), S("'c \" (d'"), S("\"e\\\\\"") }));
+        TS_ASSERT(*space.get_content()[39998] ==
+                *E({ S("say"), S("\"a ) \\\" ( b\""), S("19999") }));
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_in_parallel_quotes_inside_of_tokens() {
+        // quotes after the number token and inside of the symbol are
+        // matched by the tokenizer
+        std::string program = many_expressions_program(20000) +
+            "(a 12'b ) c' d)\n(e f'g (h) i)\n" + many_expressions_program(20000);
+        TextSpace text;
+        text.register_token(std::string("\\d+"),
+                [](std::string token) -> AtomPtr { return S("number:" + token); });
+        text.register_token(std::string("'[^']*'"),
+                [](std::string token) -> AtomPtr { return S(token); });
+        text.add_string(program);
+        GroundingSpace expected;
+        expected.add_from_space(text);
+
+        text.set_threads(4);
+        GroundingSpace space;
+        space.add_from_space(text);
+
+        TS_ASSERT_EQUALS(space.get_content().size(), 40002);
+        TS_ASSERT(*space.get_content()[20000] ==
+                *E({ S("a"), S("number:12"), S("'b ) c'"), S("d") }));
+        TS_ASSERT_EQUALS(space, expected);
+    }
+
+    void test_parse_in_parallel_reports_error() {
+        std::string program = many_expressions_program(20000) + "(a))";
+        TextSpace text;
+        text.add_string(program);
+        text.set_threads(4);
+
+        GroundingSpace space;
+        TS_ASSERT_THROWS(space.add_from_space(text), std::runtime_error);
+    }
+
     void test_parse_grounded_atom() {
         TextSpace text;
         text.register_token(std::regex("\\d+(\\.\\d+)?"),
@@ -63,4 +246,61 @@ public:
         expected.add_atom(E({ S("+"), std::make_shared<FloatAtom>(1.0), std::make_shared<FloatAtom>(2.0) }));
         TS_ASSERT_EQUALS(space, expected);
     }
+
+    void test_parse_with_shared_tokenizer() {
+        auto tokenizer = std::make_shared<Tokenizer>();
+        tokenizer->register_token("\\d+", [] (std::string str) -> AtomPtr {
+                    return std::make_shared<FloatAtom>(std::stof(str));
+                });
+        TextSpace text(tokenizer);
+        text.add_string("(+ 1 2)");
+        TextSpace other(tokenizer);
+        other.register_token("\\+", [] (std::string) -> AtomPtr { return S("add"); });
+        other.add_string("(+ 1 2)");
+
+        GroundingSpace space;
+        space.add_from_space(text);
+        space.add_from_space(other);
+
+        GroundingSpace expected;
+        expected.add_atom(E({ S("+"), std::make_shared<FloatAtom>(1), std::make_shared<FloatAtom>(2) }));
+        expected.add_atom(E({ S("add"), std::make_shared<FloatAtom>(1), std::make_shared<FloatAtom>(2) }));
+        TS_ASSERT_EQUALS(space, expected);
+        TS_ASSERT(text.get_tokenizer() == tokenizer);
+        TS_ASSERT(other.get_tokenizer() != tokenizer);
+    }
+
+    void test_register_token_after_copy() {
+        TextSpace text;
+        text.add_string("(+ 1 2)");
+        TextSpace copy(text);
+
+        text.register_token("\\+", [] (std::string) -> AtomPtr { return S("add"); });
+        GroundingSpace space;
+        space.add_from_space(text);
+        space.add_from_space(copy);
+
+        GroundingSpace expected;
+        expected.add_atom(E({ S("add"), S("1"), S("2") }));
+        expected.add_atom(E({ S("+"), S("1"), S("2") }));
+        TS_ASSERT_EQUALS(space, expected);
+        TS_ASSERT(text.get_tokenizer() != copy.get_tokenizer());
+    }
+
+    void test_add_to_space_with_atom_sink() {
+        TextSpace text;
+        text.add_string("(isa a b) c");
+        LinesSpace lines;
+        TS_ASSERT_THROWS(text.add_to(lines), std::runtime_error);
+
+        register_atom_sink<LinesSpace>([](LinesSpace& space) -> AtomSink {
+                    return [&space](AtomPtr atom) -> void {
+                        space.lines.push_back(atom->to_string());
+                    };
+                });
+        text.add_to(lines);
+
+        std::vector<std::string> expected{ "(isa a b)", "c" };
+        TS_ASSERT_EQUALS(lines.lines, expected);
+    }
 };
@@ -0,0 +1,120 @@
+#include <cxxtest/TestSuite.h>
+
+#include <hyperon/hyperon.h>
+
+std::string find_token(Tokenizer const& tokenizer, std::string text) {
+    char const* pos = text.c_str();
+    AtomPtr atom = tokenizer.find_token(pos, text.c_str() + text.size());
+    std::string rest(pos);
+    return (atom ? atom->to_string() : "INVALID") + " " + rest;
+}
+
+Tokenizer::AtomConstr token_atom(std::string name) {
+    return [name](std::string token) -> AtomPtr { return S(name + ":" + token); };
+}
+
+class TokenizerTest : public CxxTest::TestSuite {
+public:
+
+    void test_find_literal_token() {
+        Tokenizer tokenizer;
+        tokenizer.register_token(std::string("\\+"), token_atom("plus"));
+        tokenizer.register_token(std::string("=="), token_atom("eq"));
+
+        TS_ASSERT_EQUALS(find_token(tokenizer, "+ 1"), "plus:+  1");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "== 1"), "eq:==  1");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "= 1"), "INVALID = 1");
+    }
+
+    void test_find_literal_alternatives() {
+        Tokenizer tokenizer;
+        tokenizer.register_token(std::string("a|ab"), token_atom("a"));
+        tokenizer.register_token(std::string("True|False"), token_atom("bool"));
+
+        TS_ASSERT_EQUALS(find_token(tokenizer, "ab"), "a:a b");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "False"), "bool:False ");
+    }
+
+    void test_first_registered_token_wins() {
+        Tokenizer tokenizer;
+        tokenizer.register_token(std::string("\\d+"), token_atom("int"));
+        tokenizer.register_token(std::string("1"), token_atom("one"));
+        tokenizer.register_token(std::string("12"), token_atom("twelve"));
+        tokenizer.register_token(std::string("o"), token_atom("o"));
+        tokenizer.register_token(std::string("or"), token_atom("or"));
+        tokenizer.register_token(std::regex("o."), token_atom("o."));
+
+        TS_ASSERT_EQUALS(find_token(tokenizer, "12 3"), "int:12  3");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "or"), "o:o r");
+    }
+
+    void test_find_regex_token() {
+        Tokenizer tokenizer;
+        tokenizer.register_token(std::string("'[^']*'"), token_atom("str"));
+        tokenizer.register_token(std::string("call:[^\\s)]+"), token_atom("call"));
+        tokenizer.register_token(std::regex("\\d+(\\.\\d+)?"), token_atom("num"));
+
+        TS_ASSERT_EQUALS(find_token(tokenizer, "'a b' c"), "str:'a b'  c");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "call:f) c"), "call:call:f ) c");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "1.5)"), "num:1.5 )");
+        TS_ASSERT_EQUALS(find_token(tokenizer, "x"), "INVALID x");
+    }
+
+    void test_find_token_as_regex_search_does() {
+        std::vector<std::string> regexes{ "\\+", "-", "\\*", "\\/", "==", "<",
+            ">", "or", "and", "not", "\\d+(\\.\\d+)", "\\d+", "'[^']*'",
+            "True|False", "match", "call:[^\\s)]+", ",", "let", "[a-c]x?",
+            "\\w+", "[^\\d]" };
+        std::vector<std::string> texts{ "+", "-1", "*", "/", "===", "<=",
+            ">", "order", "and", "nota", "1.5", "1.", "12", "'a b'", "'a",
+            "True", "Falsey", "matches", "call:f)", ",", "letter", "ax", "c",
+            "d", "_x", "7z", "#" };
+        Tokenizer tokenizer;
+        for (auto const& regex : regexes) {
+            tokenizer.register_token(regex, token_atom(regex));
+        }
+
+        for (auto const& text : texts) {
+            std::string expected = "INVALID " + text;
+            for (auto const& regex : regexes) {
+                std::smatch match;
+                if (std::regex_search(text, match, std::regex(regex),
+                            std::regex_constants::match_continuous)) {
+                    expected = regex + ":" + match.str() + " " + match.suffix().str();
+                    break;
+                }
+            }
+            TS_ASSERT_EQUALS(find_token(tokenizer, text), expected);
+        }
+    }
+
+    void test_get_quotes_of_string_tokens() {
+        Tokenizer tokenizer;
+        for (auto const& regex : { "\\d+(\\.\\d+)?", "\\+", "True|False",
+                "[^\\s()'\"]+", "'[^']*'", "\"([^\"\\\\]|\\\\.)*\"" }) {
+            tokenizer.register_token(regex, token_atom(regex));
+        }
+
+        std::vector<Tokenizer::Quote> quotes;
+        TS_ASSERT(tokenizer.get_quotes(quotes));
+        TS_ASSERT_EQUALS(quotes.size(), 2);
+        TS_ASSERT_EQUALS(quotes[0].quote, '\'');
+        TS_ASSERT(!quotes[0].escapes);
+        TS_ASSERT_EQUALS(quotes[1].quote, '"');
+        TS_ASSERT(quotes[1].escapes);
+    }
+
+    void test_get_quotes_fails_when_token_can_contain_brackets() {
+        for (auto const& regex : { "call:[^\\s)]+", "\\(", "a.b", "x'y", "[\\W]" }) {
+            Tokenizer tokenizer;
+            tokenizer.register_token("'[^']*'", token_atom("string"));
+            tokenizer.register_token(regex, token_atom(regex));
+            std::vector<Tokenizer::Quote> quotes;
+            TS_ASSERT(!tokenizer.get_quotes(quotes));
+        }
+        Tokenizer tokenizer;
+        tokenizer.register_token(std::regex("\\d+"), token_atom("number"));
+        std::vector<Tokenizer::Quote> quotes;
+        TS_ASSERT(!tokenizer.get_quotes(quotes));
+    }
+};
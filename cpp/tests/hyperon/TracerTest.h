@@ -0,0 +1,113 @@
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+#include <thread>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+size_t count_events(std::vector<TraceEvent> const& events, TraceEvent::Type type) {
+    size_t count = 0;
+    for (auto const& event : events) {
+        count += event.type == type;
+    }
+    return count;
+}
+
+class TracerTest : public CxxTest::TestSuite {
+public:
+
+    void tearDown() {
+        Tracer::disable();
+        Tracer::clear();
+    }
+
+    void test_record_interpreter_events() {
+        GroundingSpace kb;
+        kb.add_atom(E({ S("="), E({ S("double"), V("x") }), E({ ADD, V("x"), V("x") }) }));
+        kb.add_atom(E({ S("="), E({ S("half"), V("x") }), E({ DIV, V("x"), Int(2) }) }));
+        GroundingSpace target;
+        target.add_atom(E({ S("double"), Int(21) }));
+
+        Tracer::enable();
+        AtomPtr result = interpret_until_result(target, kb);
+        Tracer::disable();
+
+        TS_ASSERT(*Int(42) == *result);
+        std::vector<TraceEvent> events = Tracer::get_events();
+        TS_ASSERT(count_events(events, TraceEvent::STEP_BEGIN) > 0);
+        TS_ASSERT_EQUALS(count_events(events, TraceEvent::STEP_BEGIN),
+                count_events(events, TraceEvent::STEP_END));
+        TS_ASSERT_EQUALS(count_events(events, TraceEvent::GROUNDED_CALL_BEGIN), 1);
+        TS_ASSERT_EQUALS(count_events(events, TraceEvent::GROUNDED_CALL_END), 1);
+        TS_ASSERT_EQUALS(count_events(events, TraceEvent::RULES_MATCHED), 1);
+        for (auto const& event : events) {
+            if (event.type == TraceEvent::MATCH_SCAN) {
+                TS_ASSERT_EQUALS(event.value, 2);
+            }
+            if (event.type == TraceEvent::GROUNDED_CALL_BEGIN) {
+                TS_ASSERT_EQUALS(event.atom, reinterpret_cast<uintptr_t>(ADD.get()));
+            }
+        }
+        for (size_t i = 1; i < events.size(); ++i) {
+            TS_ASSERT(events[i - 1].time <= events[i].time);
+        }
+    }
+
+    void test_disabled_tracer_records_nothing() {
+        Tracer::record(TraceEvent::STEP_BEGIN, nullptr);
+
+        TS_ASSERT(Tracer::get_events().empty());
+    }
+
+    void test_ring_buffer_keeps_latest_events() {
+        Tracer::enable(4);
+        for (size_t i = 0; i < 10; ++i) {
+            Tracer::record(TraceEvent::MATCH_SCAN, nullptr, i);
+        }
+
+        std::vector<TraceEvent> events = Tracer::get_events();
+        TS_ASSERT_EQUALS(events.size(), 4);
+        for (size_t i = 0; i < events.size(); ++i) {
+            TS_ASSERT_EQUALS(events[i].value, 6 + i);
+        }
+    }
+
+    void test_events_of_each_thread_are_kept_separately() {
+        Tracer::enable(16);
+        auto record = []() -> void {
+            for (size_t i = 0; i < 16; ++i) {
+                Tracer::record(TraceEvent::MATCH_SCAN, nullptr, i);
+            }
+        };
+        std::thread first(record);
+        std::thread second(record);
+        first.join();
+        second.join();
+
+        std::vector<TraceEvent> events = Tracer::get_events();
+        TS_ASSERT_EQUALS(events.size(), 32);
+        size_t first_thread = 0;
+        for (auto const& event : events) {
+            first_thread += event.thread == events[0].thread;
+        }
+        TS_ASSERT_EQUALS(first_thread, 16);
+    }
+
+    void test_write_chrome_trace() {
+        Tracer::enable();
+        {
+            TraceSpan span(TraceEvent::STEP_BEGIN, nullptr);
+            Tracer::record(TraceEvent::RULES_MATCHED, nullptr, 3);
+        }
+        std::ostringstream out;
+
+        Tracer::write_chrome_trace(out);
+
+        std::string json = out.str();
+        TS_ASSERT_EQUALS(json.find("{\"traceEvents\":["), 0);
+        TS_ASSERT(json.find("\"name\":\"step\",\"cat\":\"interpreter\",\"ph\":\"B\"") != std::string::npos);
+        TS_ASSERT(json.find("\"ph\":\"E\"") != std::string::npos);
+        TS_ASSERT(json.find("\"args\":{\"atom\":\"0x0\",\"rules\":3}") != std::string::npos);
+    }
+};
@@ -0,0 +1,64 @@
+#include <cxxtest/TestSuite.h>
+#include <algorithm>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+AtomPtr execute(AtomPtr expr) {
+    GroundingSpace targets;
+    targets.add_atom(expr);
+    return interpret_until_result(targets, GroundingSpace());
+}
+
+class GroundedOperationsTest : public CxxTest::TestSuite {
+public:
+
+    void test_compare_numbers() {
+        TS_ASSERT(*execute(E({ LESS, Int(1), Int(2) })) == *TRUE);
+        TS_ASSERT(*execute(E({ GREATER, Int(1), Int(2) })) == *FALSE);
+        TS_ASSERT(*execute(E({ LESS_EQ, Int(2), Int(2) })) == *TRUE);
+        TS_ASSERT(*execute(E({ GREATER_EQ, Float(1.5), Int(2) })) == *FALSE);
+    }
+
+    void test_logic() {
+        TS_ASSERT(*execute(E({ AND, TRUE, FALSE })) == *FALSE);
+        TS_ASSERT(*execute(E({ OR, TRUE, FALSE })) == *TRUE);
+        TS_ASSERT(*execute(E({ NOT, FALSE })) == *TRUE);
+        TS_ASSERT(*execute(E({ AND, E({ LESS, Int(1), Int(2) }), E({ NOT, FALSE }) })) == *TRUE);
+    }
+
+    void test_find_builtin_operations() {
+        TS_ASSERT_EQUALS(find_grounded_operation("+"), ADD);
+        TS_ASSERT_EQUALS(find_grounded_operation("<"), LESS);
+        TS_ASSERT_EQUALS(find_grounded_operation("and"), AND);
+        TS_ASSERT_EQUALS(find_grounded_operation("++"), CONCAT);
+        TS_ASSERT(!find_grounded_operation("unknown"));
+    }
+
+    void test_register_operation() {
+        register_grounded_operation("test-mul", MUL);
+
+        TS_ASSERT_EQUALS(find_grounded_operation("test-mul"), MUL);
+        auto names = get_grounded_operation_names();
+        TS_ASSERT(std::find(names.begin(), names.end(), "test-mul") != names.end());
+        TS_ASSERT_THROWS(register_grounded_operation("+", MUL), std::logic_error);
+    }
+
+    void test_parse_with_registered_operations() {
+        TextSpace text;
+        text.register_token(std::regex("\\d+"),
+                [] (std::string str) -> AtomPtr { return Int(std::stoi(str)); });
+        std::vector<std::pair<std::string, std::string>> tokens{
+            { "\\*", "*" }, { "<", "<" }, { "not", "not" } };
+        for (auto const& token : tokens) {
+            AtomPtr operation = find_grounded_operation(token.second);
+            text.register_token(std::regex(token.first),
+                    [operation] (std::string) -> AtomPtr { return operation; });
+        }
+        text.add_string("(not (< (* 3 4) 10))");
+        GroundingSpace targets;
+        targets.add_from_space(text);
+
+        TS_ASSERT(*interpret_until_result(targets, GroundingSpace()) == *TRUE);
+    }
+};
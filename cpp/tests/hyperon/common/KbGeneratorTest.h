@@ -0,0 +1,104 @@
+#include <cxxtest/TestSuite.h>
+
+#include <sstream>
+
+#include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
+
+size_t expr_depth(AtomPtr atom) {
+    size_t depth = 0;
+    std::vector<std::pair<AtomPtr, size_t>> stack{ { atom, 0 } };
+    while (!stack.empty()) {
+        auto top = stack.back();
+        stack.pop_back();
+        depth = std::max(depth, top.second);
+        if (top.first->get_type() == Atom::EXPR) {
+            for (auto const& child : std::static_pointer_cast<ExprAtom>(top.first)->get_children()) {
+                stack.emplace_back(child, top.second + 1);
+            }
+        }
+    }
+    return depth;
+}
+
+class KbGeneratorTest : public CxxTest::TestSuite {
+public:
+
+    void test_generate_facts_and_rules() {
+        KbGeneratorOptions options;
+        options.facts = 100;
+        options.rules = 10;
+        options.depth = 3;
+        options.arity = 4;
+        GroundingSpace kb;
+
+        KbGenerator(options).generate(kb);
+
+        auto const& content = kb.get_content();
+        TS_ASSERT_EQUALS(content.size(), 110);
+        for (size_t i = 0; i < 100; ++i) {
+            ExprAtomPtr fact = std::static_pointer_cast<ExprAtom>(content[i]);
+            TS_ASSERT_EQUALS(fact->get_children().size(), 4);
+            TS_ASSERT(!fact->has_variables());
+            TS_ASSERT(expr_depth(fact) <= 3);
+        }
+        for (size_t i = 100; i < 110; ++i) {
+            ExprAtomPtr rule = std::static_pointer_cast<ExprAtom>(content[i]);
+            TS_ASSERT(*S("=") == *rule->get_children()[0]);
+            TS_ASSERT(std::static_pointer_cast<ExprAtom>(rule->get_children()[1])->has_variables());
+        }
+    }
+
+    void test_same_seed_gives_same_kb() {
+        KbGeneratorOptions options;
+        options.facts = 50;
+        options.rules = 5;
+        options.variables = 0.2;
+        GroundingSpace a, b, c;
+
+        KbGenerator(options).generate(a);
+        KbGenerator(options).generate(b);
+        options.seed = 2;
+        KbGenerator(options).generate(c);
+
+        TS_ASSERT(a == b);
+        TS_ASSERT(a != c);
+    }
+
+    void test_zipf_skew() {
+        KbGeneratorOptions options;
+        options.facts = 1000;
+        options.arity = 1;
+        options.symbols = 100;
+        options.skew = 2.0;
+        GroundingSpace kb;
+
+        KbGenerator(options).generate(kb);
+
+        size_t first = 0;
+        for (auto const& fact : kb.get_content()) {
+            first += *E({ S("s1") }) == *fact;
+        }
+        // probability of the first symbol is 1 / zeta(2) ~ 0.61
+        TS_ASSERT(first > 500 && first < 700);
+    }
+
+    void test_generated_text_is_parsed_back() {
+        KbGeneratorOptions options;
+        options.facts = 100;
+        options.rules = 10;
+        options.depth = 2;
+        options.variables = 0.3;
+        GroundingSpace expected;
+        KbGenerator(options).generate(expected);
+        std::ostringstream out;
+
+        KbGenerator(options).generate(out);
+
+        TextSpace text;
+        text.add_string(out.str());
+        GroundingSpace kb;
+        kb.add_from_space(text);
+        TS_ASSERT(kb == expected);
+    }
+};
@@ -3,10 +3,28 @@ from hyperonpy import (
         S,
         V,
         E as _E,
+        atom_from_tuple,
+        atoms_from_tuples,
+        deserialize_atoms,
         GroundedAtom,
+        NumAtom,
+        Int,
+        Float,
+        BoolAtom,
+        Bool,
+        StringAtom,
+        String,
+        get_native_operation,
+        get_native_operation_names,
         GroundingSpace,
         TextSpace,
+        Tokenizer,
+        FrozenTokenizer,
         Logger,
+        Tracer,
+        Profiler,
+        Metrics,
+        MetricsSnapshot,
         IFMATCH)
 
 def E(*args):
@@ -1,27 +1,49 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <sstream>
+#include <unordered_map>
+
 #include <hyperon/hyperon.h>
+#include <hyperon/common/common.h>
 
 namespace py = pybind11;
 
+// Long running methods release the GIL to let other Python threads work.
+// Each C++ method which calls back into Python (overriden virtual methods,
+// token constructors, releasing Python references) should acquire the GIL
+// because it can be called from such method or from a parser thread.
+//
+// GroundingSpace is not synchronized, so code which runs without the GIL
+// works on private copies of the spaces only. Copy of the space shares its
+// content until the space is changed, so it is taken in constant time while
+// the GIL is held. Results are added into the original spaces after the GIL
+// is acquired again.
+GroundingSpace snapshot(GroundingSpace const& space) {
+    return GroundingSpace(space);
+}
+
 class PySpaceAPI : public SpaceAPI {
 public:
     using SpaceAPI::SpaceAPI;
 
     void add_to(SpaceAPI& graph) const override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE(void, SpaceAPI, add_to, graph);
     }
 
     void add_from_space(const SpaceAPI& graph) override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE(void, SpaceAPI, add_from_space, graph);
     }
 
     void add_native(const SpaceAPI* pGraph) override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE(void, SpaceAPI, add_native, pGraph);
     }
 
     std::string get_type() const override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE(std::string, SpaceAPI, get_type,)
     }
     
@@ -36,7 +58,10 @@ template<typename T>
 std::shared_ptr<T> py_shared_ptr(py::handle pyobj) {
     pyobj.inc_ref();
     return std::shared_ptr<T>(pyobj.cast<T*>(),
-            [](T* p) -> void { py::cast(p).dec_ref(); });
+            [](T* p) -> void {
+                py::gil_scoped_acquire gil;
+                py::cast(p).dec_ref();
+            });
 }
 
 std::vector<AtomPtr> py_list(py::list atoms) {
@@ -47,11 +72,58 @@ std::vector<AtomPtr> py_list(py::list atoms) {
     return content;
 }
 
+// Converts nested Python tuples and lists into atoms in a single call: a
+// string which starts from '$' is a variable, other string is a symbol,
+// tuple or list is an expression, atom is used as is. Symbols and variables
+// with the same name are shared between atoms converted by one converter.
+class TupleConverter {
+public:
+    AtomPtr convert(py::handle obj) {
+        if (py::isinstance<py::str>(obj)) {
+            std::string name = obj.cast<std::string>();
+            auto it = names.find(name);
+            if (it != names.end()) {
+                return it->second;
+            }
+            AtomPtr atom = name.size() > 1 && name[0] == '$' ? AtomPtr(V(name.substr(1))) : AtomPtr(S(name));
+            names.emplace(name, atom);
+            return atom;
+        }
+        if (py::isinstance<py::tuple>(obj) || py::isinstance<py::list>(obj)) {
+            std::vector<AtomPtr> children;
+            children.reserve(py::len(obj));
+            for (py::handle child : obj) {
+                children.push_back(convert(child));
+            }
+            return E(std::move(children));
+        }
+        if (py::isinstance<Atom>(obj)) {
+            return py_shared_ptr<Atom>(obj);
+        }
+        throw py::type_error("Cannot convert to atom: " + py::repr(obj).cast<std::string>());
+    }
+
+    std::vector<AtomPtr> convert_all(py::iterable items) {
+        std::vector<AtomPtr> atoms;
+        if (py::hasattr(items, "__len__")) {
+            atoms.reserve(py::len(items));
+        }
+        for (py::handle item : items) {
+            atoms.push_back(convert(item));
+        }
+        return atoms;
+    }
+
+private:
+    std::unordered_map<std::string, AtomPtr> names;
+};
+
 class PyAtom : public Atom {
 public:
     using Atom::Atom;
 
     bool operator==(Atom const& other) const override {
+        py::gil_scoped_acquire gil;
         // workaround for a pybind11 issue https://github.com/pybind/pybind11/issues/2033
         // see https://stackoverflow.com/a/59331026/14016260 for explanation
         py::object dummy = py::cast(&other);
@@ -59,6 +131,7 @@ public:
     }
 
     std::string to_string() const override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE_NAME(std::string, Atom, "__repr__", to_string,);
     }
 };
@@ -67,15 +140,25 @@ class PyGroundedAtom : public GroundedAtom {
 public:
     using GroundedAtom::GroundedAtom;
 
+    // Python gets its own copies of the spaces, so views of their content
+    // and the spaces themselves are still valid when they are kept after
+    // execute() returns. Copies share the content with the spaces and are
+    // created in constant time, the result is copied back the same way.
     void execute(GroundingSpace const& args, GroundingSpace& result) const override {
-        // workaround for a pybind11 issue https://github.com/pybind/pybind11/issues/2033
-        // see https://stackoverflow.com/a/59331026/14016260 for explanation
-        py::object dummy0 = py::cast(&args);
-        py::object dummy1 = py::cast(&result);
-        PYBIND11_OVERLOAD(void, GroundedAtom, execute, args, result);
+        py::gil_scoped_acquire gil;
+        py::function overload = py::get_overload(static_cast<GroundedAtom const*>(this), "execute");
+        if (!overload) {
+            GroundedAtom::execute(args, result);
+            return;
+        }
+        py::object py_args = py::cast(GroundingSpace(args));
+        py::object py_result = py::cast(GroundingSpace(result));
+        overload(py_args, py_result);
+        result = py_result.cast<GroundingSpace const&>();
     }
 
     bool operator==(Atom const& other) const override {
+        py::gil_scoped_acquire gil;
         // workaround for a pybind11 issue https://github.com/pybind/pybind11/issues/2033
         // see https://stackoverflow.com/a/59331026/14016260 for explanation
         py::object dummy = py::cast(&other);
@@ -83,6 +166,7 @@ public:
     }
 
     std::string to_string() const override {
+        py::gil_scoped_acquire gil;
         PYBIND11_OVERLOAD_PURE_NAME(std::string, GroundedAtom, "__repr__", to_string,);
     }
 };
@@ -90,13 +174,17 @@ public:
 struct PyHandleHolder {
     py::handle obj;
     PyHandleHolder(py::handle obj) : obj(obj) { obj.inc_ref(); }
-    ~PyHandleHolder() { obj.dec_ref(); }
+    ~PyHandleHolder() {
+        py::gil_scoped_acquire gil;
+        obj.dec_ref();
+    }
 };
 
 class PyAtomConstr {
 public:
     PyAtomConstr(py::object lambda) : lambda(std::make_shared<PyHandleHolder>(lambda)) { }
     AtomPtr operator()(std::string arg) {
+        py::gil_scoped_acquire gil;
         py::object atom = lambda->obj(arg);
         return py_shared_ptr<Atom>(atom);
     }
@@ -104,12 +192,211 @@ private:
     std::shared_ptr<PyHandleHolder> lambda;
 };
 
+// Copy of the tokenizer which cannot be changed from Python, so it is
+// shared by text spaces without copying. Spaces created from Tokenizer
+// copy it, so tokens registered later don't change them.
+struct FrozenTokenizer {
+    std::shared_ptr<Tokenizer const> tokenizer;
+};
+
+// Serialized atoms are read as contiguous bytes, so strided buffers like
+// slices of memoryview with a step are rejected
+static py::buffer_info request_contiguous(py::buffer const& buffer) {
+    py::buffer_info info = buffer.request();
+    py::ssize_t stride = info.itemsize;
+    for (py::ssize_t i = info.ndim - 1; i >= 0; --i) {
+        if (info.shape[i] > 1 && info.strides[i] != stride) {
+            throw py::buffer_error("Buffer should be C contiguous");
+        }
+        stride *= info.shape[i];
+    }
+    return info;
+}
+
+// Read only Python sequence over the vector of atoms owned by an ExprAtom
+// or a GroundingSpace. Atoms are not copied, items are converted into Python
+// objects on access. Owner of the vector is kept alive by py::keep_alive,
+// view of the space content reflects further changes of the space. Owner
+// should be a Python object: spaces passed to GroundedAtom.execute() are
+// Python owned copies for this reason.
+class AtomVectorView {
+public:
+    AtomVectorView(std::vector<AtomPtr> const& atoms) : atoms(&atoms), space(nullptr) { }
+    // Space replaces its content vector when it is changed while the vector
+    // is shared with copies, so content is taken from the space on access
+    AtomVectorView(GroundingSpace const& space) : atoms(nullptr), space(&space) { }
+
+    size_t size() const { return get_atoms().size(); }
+
+    AtomPtr get(py::ssize_t index) const {
+        py::ssize_t size = static_cast<py::ssize_t>(get_atoms().size());
+        if (index < 0) {
+            index += size;
+        }
+        if (index < 0 || index >= size) {
+            throw py::index_error("index out of range");
+        }
+        return get_atoms()[index];
+    }
+
+    py::list get_slice(py::slice slice) const {
+        size_t start, stop, step, length;
+        if (!slice.compute(get_atoms().size(), &start, &stop, &step, &length)) {
+            throw py::error_already_set();
+        }
+        py::list result(length);
+        for (size_t i = 0; i < length; ++i, start += step) {
+            result[i] = py::cast(get_atoms()[start]);
+        }
+        return result;
+    }
+
+    bool equals(py::object other) const {
+        if (!py::isinstance<py::sequence>(other) || py::len(other) != get_atoms().size()) {
+            return false;
+        }
+        py::sequence items = other.cast<py::sequence>();
+        for (size_t i = 0; i < get_atoms().size(); ++i) {
+            if (!py::cast(get_atoms()[i]).equal(items[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::string to_string() const {
+        std::ostringstream out;
+        out << '[';
+        write_to(out, get_atoms(), ", ");
+        out << ']';
+        return out.str();
+    }
+
+private:
+    std::vector<AtomPtr> const& get_atoms() const {
+        return space ? space->get_content() : *atoms;
+    }
+
+    std::vector<AtomPtr> const* atoms;
+    GroundingSpace const* space;
+};
+
+// Iterator checks the size of the vector on each step, so it is safe to
+// change the space while iterating over its content
+class AtomVectorIterator {
+public:
+    AtomVectorIterator(AtomVectorView const& view) : view(view), index(0) { }
+
+    AtomPtr next() {
+        if (index >= view.size()) {
+            throw py::stop_iteration();
+        }
+        return view.get(index++);
+    }
+
+private:
+    AtomVectorView view;
+    size_t index;
+};
+
+// Read only bindings of the match result, values are accessed by variable
+// name like in dict
+class PyBindings {
+public:
+    PyBindings(Bindings bindings) : bindings(std::move(bindings)) { }
+
+    AtomPtr get(std::string const& name) const {
+        auto binding = bindings.find(V(name));
+        if (binding == bindings.end()) {
+            throw py::key_error(name);
+        }
+        return binding->second;
+    }
+
+    bool contains(std::string const& name) const { return bindings.count(V(name)); }
+    size_t size() const { return bindings.size(); }
+
+    std::vector<std::string> keys() const {
+        std::vector<std::string> names;
+        for (auto const& binding : bindings) {
+            names.push_back(binding.first->get_name());
+        }
+        return names;
+    }
+
+    std::string to_string() const {
+        std::ostringstream out;
+        out << '{';
+        for (auto it = bindings.begin(); it != bindings.end(); ++it) {
+            out << (it == bindings.begin() ? "" : ", ") << *it->first << ": " << *it->second;
+        }
+        out << '}';
+        return out.str();
+    }
+
+private:
+    Bindings bindings;
+};
+
+// Python iterator over MatchIterator results, stops after limit matches
+// when limit is not 0
+class PyMatchIterator {
+public:
+    // Iterator shares the content of the space, so the space can be changed
+    // while iterating and matching runs without the GIL
+    PyMatchIterator(MatchIterator iterator, size_t limit)
+        : iterator(std::move(iterator)), limit(limit), count(0) { }
+
+    PyBindings next() {
+        if (limit && count >= limit) {
+            throw py::stop_iteration();
+        }
+        Bindings bindings;
+        bool found;
+        {
+            py::gil_scoped_release release;
+            found = iterator.next(bindings);
+        }
+        if (!found) {
+            throw py::stop_iteration();
+        }
+        ++count;
+        return PyBindings(std::move(bindings));
+    }
+
+private:
+    MatchIterator iterator;
+    size_t limit;
+    size_t count;
+};
+
+// Text is parsed without the GIL into a private space, other spaces are
+// added while the GIL is held
+void add_space(SpaceAPI const& from, SpaceAPI& to) {
+    TextSpace const* text = dynamic_cast<TextSpace const*>(&from);
+    if (!text) {
+        from.add_to(to);
+        return;
+    }
+    TextSpace text_copy(*text);
+    GroundingSpace atoms = GroundingSpace::scratch();
+    {
+        py::gil_scoped_release release;
+        text_copy.add_to(atoms);
+    }
+    atoms.add_to(to);
+}
+
 PYBIND11_MODULE(hyperonpy, m) {
 
     py::class_<SpaceAPI, PySpaceAPI>(m, "SpaceAPI")
         .def(py::init<>())
-        .def("add_to", &SpaceAPI::add_to)
-        .def("add_from_space", &SpaceAPI::add_from_space)
+        .def("add_to", [](SpaceAPI const& self, SpaceAPI& space) -> void {
+                    add_space(self, space);
+                })
+        .def("add_from_space", [](SpaceAPI& self, SpaceAPI const& space) -> void {
+                    add_space(space, self);
+                })
         .def("add_native", &SpaceAPI::add_native)
         .def("get_type", &SpaceAPI::get_type);
 
@@ -138,22 +425,103 @@ PYBIND11_MODULE(hyperonpy, m) {
 
     m.def("V", &V); 
 
-    // TODO: bingings below are not effective as pybind11 by default copies
-    // vectors when converting Python lists to them and vice versa. Better way
-    // is adapting Python list interface to std::vector or introduce light
-    // container interface instead of std::vector and adapt Python list to it.
+    py::class_<AtomVectorView>(m, "AtomVectorView")
+        .def("__len__", &AtomVectorView::size)
+        .def("__getitem__", &AtomVectorView::get)
+        .def("__getitem__", &AtomVectorView::get_slice)
+        .def("__iter__", [](AtomVectorView const& self) -> AtomVectorIterator {
+                    return AtomVectorIterator(self);
+                }, py::keep_alive<0, 1>())
+        .def("__eq__", &AtomVectorView::equals)
+        .def("__repr__", &AtomVectorView::to_string);
+
+    py::class_<AtomVectorIterator>(m, "AtomVectorIterator")
+        .def("__iter__", [](py::object self) -> py::object { return self; })
+        .def("__next__", &AtomVectorIterator::next);
+
+    // TODO: Python list is still copied into std::vector when ExprAtom is
+    // constructed, children are returned without copying
     py::class_<ExprAtom, std::shared_ptr<ExprAtom>, Atom>(m, "ExprAtom")
         .def(py::init<std::vector<AtomPtr>>())
-        .def("get_children", &ExprAtom::get_children);
+        .def("get_children", [](ExprAtom const& self) -> AtomVectorView {
+                    return AtomVectorView(self.get_children());
+                }, py::keep_alive<0, 1>());
 
     m.def("E", [](py::list atoms) -> AtomPtr { return E(py_list(atoms)); });
 
+    m.def("atom_from_tuple", [](py::handle obj) -> AtomPtr {
+                return TupleConverter().convert(obj);
+            });
+    m.def("atoms_from_tuples", [](py::iterable items) -> std::vector<AtomPtr> {
+                return TupleConverter().convert_all(items);
+            });
+    m.def("deserialize_atoms", [](py::buffer buffer) -> std::vector<AtomPtr> {
+                py::buffer_info info = request_contiguous(buffer);
+                char const* data = static_cast<char const*>(info.ptr);
+                py::gil_scoped_release release;
+                return ::deserialize(data, data + info.size * info.itemsize);
+            });
+
     py::class_<GroundedAtom, PyGroundedAtom, std::shared_ptr<GroundedAtom>, Atom>(m, "GroundedAtom")
         .def(py::init<>())
         .def("execute", &GroundedAtom::execute)
         .def("__eq__", &GroundedAtom::operator==)
         .def("__repr__", &GroundedAtom::to_string);
 
+    // Native values and operations from hyperon_common, expressions built
+    // from them are executed without calling back into Python
+    py::class_<NumAtom, GroundedAtom, std::shared_ptr<NumAtom>>(m, "NumAtom")
+        .def_property_readonly("value", [](NumAtom const& self) -> py::object {
+                    NumValue value = self.get();
+                    if (value.type == NumValue::INT) {
+                        return py::int_(value.value.i);
+                    }
+                    return py::float_(value.value.f);
+                });
+    m.def("Int", &Int);
+    m.def("Float", &Float);
+
+    py::class_<BoolAtom, GroundedAtom, std::shared_ptr<BoolAtom>>(m, "BoolAtom")
+        .def_property_readonly("value", [](BoolAtom const& self) -> bool { return self.get(); });
+    m.def("Bool", &Bool);
+
+    py::class_<StringAtom, GroundedAtom, std::shared_ptr<StringAtom>>(m, "StringAtom")
+        .def_property_readonly("value", [](StringAtom const& self) -> std::string { return self.get(); });
+    m.def("String", &String);
+
+    m.def("get_native_operation", [](std::string name) -> GroundedAtomPtr {
+                GroundedAtomPtr operation = find_grounded_operation(name);
+                if (!operation) {
+                    throw py::key_error("Native operation is not found: " + name);
+                }
+                return operation;
+            });
+    m.def("get_native_operation_names", &get_grounded_operation_names);
+
+    py::class_<PyBindings>(m, "Bindings")
+        .def("__getitem__", &PyBindings::get)
+        .def("__contains__", &PyBindings::contains)
+        .def("__len__", &PyBindings::size)
+        .def("__iter__", [](PyBindings const& self) -> py::iterator {
+                    return py::iter(py::cast(self.keys()));
+                })
+        .def("keys", &PyBindings::keys)
+        .def("__repr__", &PyBindings::to_string);
+
+    py::class_<PyMatchIterator>(m, "MatchIterator")
+        .def("__iter__", [](py::object self) -> py::object { return self; })
+        .def("__next__", &PyMatchIterator::next);
+
+    py::class_<MemoryUsage>(m, "MemoryUsage")
+        .def_readonly("atoms", &MemoryUsage::atoms)
+        .def_readonly("unique_atoms", &MemoryUsage::unique_atoms)
+        .def_readonly("shared_atoms", &MemoryUsage::shared_atoms)
+        .def_readonly("atom_bytes", &MemoryUsage::atom_bytes)
+        .def_readonly("string_bytes", &MemoryUsage::string_bytes)
+        .def_readonly("children_bytes", &MemoryUsage::children_bytes)
+        .def_readonly("index_bytes", &MemoryUsage::index_bytes)
+        .def("get_total_bytes", &MemoryUsage::get_total_bytes);
+
     py::class_<GroundingSpace, SpaceAPI>(m, "GroundingSpace")
         .def(py::init<>())
         .def(py::init([](py::list atoms) -> GroundingSpace* {
@@ -163,19 +531,114 @@ PYBIND11_MODULE(hyperonpy, m) {
         .def("add_atom", [](GroundingSpace* self, py::object atom) -> void {
                     self->add_atom(py_shared_ptr<Atom>(atom));
                 })
-        .def("interpret_step", &GroundingSpace::interpret_step)
-        .def("match", (void (GroundingSpace::*)(SpaceAPI const&, SpaceAPI const&, GroundingSpace&) const) &GroundingSpace::match)
-        .def("get_content", &GroundingSpace::get_content)
+        // items are atoms or tuples accepted by atom_from_tuple()
+        .def("add_atoms", [](GroundingSpace* self, py::iterable items) -> void {
+                    self->add_atoms(TupleConverter().convert_all(items));
+                })
+        .def("serialize", [](GroundingSpace const& self) -> py::bytes {
+                    GroundingSpace space = snapshot(self);
+                    std::ostringstream out;
+                    {
+                        py::gil_scoped_release release;
+                        space.serialize(out);
+                    }
+                    return py::bytes(out.str());
+                })
+        .def("deserialize", [](GroundingSpace* self, py::buffer buffer) -> void {
+                    py::buffer_info info = request_contiguous(buffer);
+                    char const* data = static_cast<char const*>(info.ptr);
+                    std::vector<AtomPtr> atoms;
+                    {
+                        py::gil_scoped_release release;
+                        atoms = ::deserialize(data, data + info.size * info.itemsize);
+                    }
+                    self->add_atoms(atoms);
+                })
+        // The step is executed on the top atom moved into a private space,
+        // results are pushed back into the space
+        .def("interpret_step", [](GroundingSpace& self, SpaceAPI const& kb) -> AtomPtr {
+                    if (self.get_content().empty()) {
+                        return S("eos");
+                    }
+                    GroundingSpace step = GroundingSpace::scratch();
+                    step.add_atom(self.pop_atom());
+                    GroundingSpace const* grounding_kb = dynamic_cast<GroundingSpace const*>(&kb);
+                    AtomPtr result;
+                    if (grounding_kb) {
+                        GroundingSpace kb_copy = snapshot(*grounding_kb);
+                        py::gil_scoped_release release;
+                        result = step.interpret_step(kb_copy);
+                    } else {
+                        result = step.interpret_step(kb);
+                    }
+                    self.add_atoms(step.get_content());
+                    return result;
+                })
+        .def("match", [](GroundingSpace const& self, GroundingSpace const& pattern,
+                        GroundingSpace const& templ, GroundingSpace& result) -> void {
+                    GroundingSpace kb = snapshot(self);
+                    GroundingSpace pattern_copy = snapshot(pattern);
+                    GroundingSpace templ_copy = snapshot(templ);
+                    GroundingSpace matches = GroundingSpace::scratch();
+                    {
+                        py::gil_scoped_release release;
+                        kb.match(pattern_copy, templ_copy, matches);
+                    }
+                    result.add_atoms(matches.get_content());
+                })
+        .def("match", [](GroundingSpace const& self, py::object pattern) -> std::vector<PyBindings> {
+                    AtomPtr atom = py_shared_ptr<Atom>(pattern);
+                    GroundingSpace kb = snapshot(self);
+                    std::vector<Bindings> results;
+                    {
+                        py::gil_scoped_release release;
+                        results = kb.match(atom);
+                    }
+                    return std::vector<PyBindings>(results.begin(), results.end());
+                })
+        .def("match_iter", [](GroundingSpace const& self, py::object pattern, size_t limit) -> PyMatchIterator {
+                    return PyMatchIterator(self.match_iterator(py_shared_ptr<Atom>(pattern)), limit);
+                }, py::arg("pattern"), py::arg("limit") = 0)
+        .def("get_content", [](GroundingSpace const& self) -> AtomVectorView {
+                    return AtomVectorView(self);
+                }, py::keep_alive<0, 1>())
+        .def("write_to_file", [](GroundingSpace const& self, std::string path) -> void {
+                    GroundingSpace space = snapshot(self);
+                    py::gil_scoped_release release;
+                    space.write_to_file(path);
+                })
+        .def("get_atom_count", &GroundingSpace::get_atom_count)
+        .def("get_memory_usage", &GroundingSpace::get_memory_usage)
         .def("__eq__", &GroundingSpace::operator==)
         .def("__repr__", &GroundingSpace::to_string);
     
+    py::class_<Tokenizer, std::shared_ptr<Tokenizer>>(m, "Tokenizer")
+        .def(py::init<>())
+        .def("register_token",
+                [](Tokenizer* self, std::string regex, py::object constr) -> void {
+                    self->register_token(regex, PyAtomConstr(constr));
+                })
+        .def("freeze", [](Tokenizer const& self) -> FrozenTokenizer {
+                    return FrozenTokenizer{ std::make_shared<Tokenizer const>(self) };
+                });
+
+    py::class_<FrozenTokenizer>(m, "FrozenTokenizer");
+
     py::class_<TextSpace, SpaceAPI>(m, "TextSpace")
         .def(py::init<>())
+        .def(py::init([](FrozenTokenizer const& tokenizer) {
+                        return new TextSpace(tokenizer.tokenizer);
+                    }))
+        .def(py::init([](Tokenizer const& tokenizer) {
+                        return new TextSpace(std::make_shared<Tokenizer const>(tokenizer));
+                    }))
         .def_readonly_static("TYPE", &TextSpace::TYPE)
         .def("add_string", &TextSpace::add_string)
+        .def("add_file", &TextSpace::add_file)
+        .def("set_threads", &TextSpace::set_threads)
         .def("register_token",
                 [](TextSpace* self, std::string regex, py::object constr) -> void {
-                    self->register_token(std::regex(regex), PyAtomConstr(constr));
+                    self->register_token(regex, PyAtomConstr(constr));
                 });
 
     py::class_<Logger> logger(m, "Logger");
@@ -188,6 +651,63 @@ PYBIND11_MODULE(hyperonpy, m) {
         .value("TRACE", Logger::Level::TRACE)
         .export_values();
 
+    py::class_<Tracer>(m, "Tracer")
+        .def_static("enable", &Tracer::enable, py::arg("capacity") = Tracer::DEFAULT_CAPACITY)
+        .def_static("disable", &Tracer::disable)
+        .def_static("is_enabled", &Tracer::is_enabled)
+        .def_static("clear", &Tracer::clear)
+        .def_static("write_chrome_trace_file", &Tracer::write_chrome_trace_file);
+
+    py::class_<RuleProfile>(m, "RuleProfile")
+        .def_readonly("rule", &RuleProfile::rule)
+        .def_readonly("tests", &RuleProfile::tests)
+        .def_readonly("unifications", &RuleProfile::unifications)
+        .def_readonly("results", &RuleProfile::results)
+        .def_readonly("time", &RuleProfile::time);
+
+    py::class_<GroundedProfile>(m, "GroundedProfile")
+        .def_readonly("atom", &GroundedProfile::atom)
+        .def_readonly("calls", &GroundedProfile::calls)
+        .def_readonly("exceptions", &GroundedProfile::exceptions)
+        .def_readonly("results", &GroundedProfile::results)
+        .def_readonly("time", &GroundedProfile::time);
+
+    py::class_<Profiler>(m, "Profiler")
+        .def_static("enable", &Profiler::enable)
+        .def_static("disable", &Profiler::disable)
+        .def_static("is_enabled", &Profiler::is_enabled)
+        .def_static("clear", &Profiler::clear)
+        .def_static("get_rules", &Profiler::get_rules)
+        .def_static("get_grounded", &Profiler::get_grounded)
+        .def_static("get_report", &Profiler::get_report);
+
+    py::class_<OperationMetrics>(m, "OperationMetrics")
+        .def_readonly("calls", &OperationMetrics::calls)
+        .def_readonly("total_time", &OperationMetrics::total_time)
+        .def_readonly("latency", &OperationMetrics::latency)
+        .def("get_percentile", &OperationMetrics::get_percentile);
+
+    py::class_<MetricsSnapshot> snapshot(m, "MetricsSnapshot");
+    snapshot.def_readonly("operations", &MetricsSnapshot::operations)
+        .def_readonly("candidates_examined", &MetricsSnapshot::candidates_examined)
+        .def_readonly("candidates_matched", &MetricsSnapshot::candidates_matched)
+        .def_readonly("atoms_added", &MetricsSnapshot::atoms_added)
+        .def("get_operation", [](MetricsSnapshot const& self,
+                    MetricsSnapshot::Operation operation) -> OperationMetrics {
+                return self.operations[operation];
+            });
+
+    py::enum_<MetricsSnapshot::Operation>(snapshot, "Operation")
+        .value("MATCH", MetricsSnapshot::Operation::MATCH)
+        .value("UNIFY", MetricsSnapshot::Operation::UNIFY)
+        .value("ADD_ATOM", MetricsSnapshot::Operation::ADD_ATOM)
+        .value("INTERPRET_STEP", MetricsSnapshot::Operation::INTERPRET_STEP)
+        .export_values();
+
+    py::class_<Metrics>(m, "Metrics")
+        .def_static("get_snapshot", &Metrics::get_snapshot)
+        .def_static("reset", &Metrics::reset);
+
     m.attr("IFMATCH") = IFMATCH;
 }
 
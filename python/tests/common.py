@@ -172,43 +172,70 @@ class AtomspaceAtom(ValueAtom):
 
 class Atomese:
 
-    def __init__(self):
+    # When native is True numbers, booleans, strings and operations on them
+    # are native C++ atoms, so arithmetic is executed without calling Python
+    def __init__(self, native=False):
         self.tokens = {}
-
-    def _parser(self):
-        parser = TextSpace()
-        parser.register_token("\+", lambda token: AddAtom())
-        parser.register_token("-", lambda token: SubAtom())
-        parser.register_token("\*", lambda token: MulAtom())
-        parser.register_token("\/", lambda token: DivAtom())
-        parser.register_token("==", lambda token: EqualAtom())
-        parser.register_token("<", lambda token: LessAtom())
-        parser.register_token(">", lambda token: GreaterAtom())
-        parser.register_token("or", lambda token: OrAtom())
-        parser.register_token("and", lambda token: AndAtom())
-        parser.register_token("not", lambda token: NotAtom())
-        parser.register_token("\\d+(\.\\d+)", lambda token: ValueAtom(float(token)))
-        parser.register_token("\\d+", lambda token: ValueAtom(int(token)))
-        parser.register_token("'[^']*'", lambda token: ValueAtom(str(token[1:-1])))
-        parser.register_token("True|False", lambda token: ValueAtom(token == 'True'))
-        parser.register_token("match", lambda token: MatchAtom())
-        parser.register_token("call:[^\\s)]+", lambda token: CallAtom(token[5:]))
-        parser.register_token(",", lambda token: CommaAtom())
-        parser.register_token("let", lambda token: IFMATCH)
+        self.tokenizer = None
+        self.native = native
+
+    # Tokenizer is built once and shared frozen by all parsed texts, it is
+    # rebuilt only after new token is added
+    def _tokenizer(self):
+        if self.tokenizer is not None:
+            return self.tokenizer
+        tokenizer = Tokenizer()
+        if self.native:
+            self._register_native_tokens(tokenizer)
+        else:
+            self._register_python_tokens(tokenizer)
+        tokenizer.register_token("match", lambda token: MatchAtom())
+        tokenizer.register_token("call:[^\\s)]+", lambda token: CallAtom(token[5:]))
+        tokenizer.register_token(",", lambda token: CommaAtom())
+        tokenizer.register_token("let", lambda token: IFMATCH)
         for regexp in self.tokens.keys():
-            parser.register_token(regexp, self.tokens[regexp])
-        return parser
+            tokenizer.register_token(regexp, self.tokens[regexp])
+        self.tokenizer = tokenizer.freeze()
+        return self.tokenizer
+
+    def _register_native_tokens(self, tokenizer):
+        operations = { "\+": "+", "-": "-", "\*": "*", "\/": "/", "==": "==",
+                "<": "<", ">": ">", "or": "or", "and": "and", "not": "not" }
+        for regexp, name in operations.items():
+            operation = get_native_operation(name)
+            tokenizer.register_token(regexp, lambda token, op=operation: op)
+        tokenizer.register_token("\\d+(\.\\d+)", lambda token: Float(float(token)))
+        tokenizer.register_token("\\d+", lambda token: Int(int(token)))
+        tokenizer.register_token("'[^']*'", lambda token: String(str(token[1:-1])))
+        tokenizer.register_token("True|False", lambda token: Bool(token == 'True'))
+
+    def _register_python_tokens(self, tokenizer):
+        tokenizer.register_token("\+", lambda token: AddAtom())
+        tokenizer.register_token("-", lambda token: SubAtom())
+        tokenizer.register_token("\*", lambda token: MulAtom())
+        tokenizer.register_token("\/", lambda token: DivAtom())
+        tokenizer.register_token("==", lambda token: EqualAtom())
+        tokenizer.register_token("<", lambda token: LessAtom())
+        tokenizer.register_token(">", lambda token: GreaterAtom())
+        tokenizer.register_token("or", lambda token: OrAtom())
+        tokenizer.register_token("and", lambda token: AndAtom())
+        tokenizer.register_token("not", lambda token: NotAtom())
+        tokenizer.register_token("\\d+(\.\\d+)", lambda token: ValueAtom(float(token)))
+        tokenizer.register_token("\\d+", lambda token: ValueAtom(int(token)))
+        tokenizer.register_token("'[^']*'", lambda token: ValueAtom(str(token[1:-1])))
+        tokenizer.register_token("True|False", lambda token: ValueAtom(token == 'True'))
 
     def parse(self, program, kb=None):
         if not kb:
             kb = GroundingSpace()
-        text = self._parser()
+        text = TextSpace(self._tokenizer())
         text.add_string(program)
         kb.add_from_space(text)
         return kb
 
     def add_token(self, regexp, constr):
         self.tokens[regexp] = constr
+        self.tokenizer = None
 
     def add_atom(self, name, symbol):
         self.add_token(name, lambda _: symbol)
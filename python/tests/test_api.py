@@ -48,6 +48,17 @@ class ApiTest(unittest.TestCase):
     def test_grounded_execute(self):
         self.assertEqual(X2Atom().execute(ValueAtom(1.0)), ValueAtom(2.0))
 
+    def test_grounded_execute_spaces_outlive_call(self):
+        atom = KeepArgsAtom()
+        target = GroundingSpace()
+        target.add_atom(E(atom, S("a"), S("b")))
+        result = None
+        while not result:
+            result = target.interpret_step(GroundingSpace())
+        self.assertEqual(result, S("done"))
+        self.assertEqual(atom.args, [atom, S("a"), S("b")])
+        self.assertEqual(atom.result.get_content(), [S("done")])
+
     def test_expr_equals(self):
         self.assertEqual(E(S("+"), S("1"), S("2")),
                 E(S("+"), S("1"), S("2")))
@@ -66,6 +77,17 @@ class ApiTest(unittest.TestCase):
         self.assertEqual(E(X2Atom(), ValueAtom(1.0)).get_children(),
                 [X2Atom(), ValueAtom(1.0)])
 
+    def test_expr_get_children_view(self):
+        children = E(S("a"), S("b"), S("c")).get_children()
+        self.assertEqual(len(children), 3)
+        self.assertEqual(children[0], S("a"))
+        self.assertEqual(children[-1], S("c"))
+        self.assertEqual(children[1:], [S("b"), S("c")])
+        self.assertEqual(list(children), [S("a"), S("b"), S("c")])
+        self.assertEqual(str(children), "[a, b, c]")
+        with self.assertRaises(IndexError):
+            children[3]
+
     def test_groundingspace_get_type(self):
         kb = GroundingSpace()
         self.assertEqual(kb.get_type(), GroundingSpace.TYPE)
@@ -82,6 +104,46 @@ class ApiTest(unittest.TestCase):
         kb_b.add_atom(E(S("+"), S("1"), S("2")))
         self.assertEqual(kb_a, kb_b)
 
+    def test_groundingspace_get_content_view(self):
+        kb = GroundingSpace()
+        kb.add_atom(S("a"))
+        content = kb.get_content()
+        kb.add_atom(S("b"))
+        self.assertEqual(content, [S("a"), S("b")])
+
+    def test_atom_from_tuple(self):
+        atom = atom_from_tuple(("isa", "$x", ("color", ValueAtom(1.0))))
+        self.assertEqual(atom, E(S("isa"), V("x"), E(S("color"), ValueAtom(1.0))))
+
+    def test_groundingspace_add_atoms(self):
+        kb = GroundingSpace()
+        kb.add_atoms([S("a"), ("isa", "b", "c")])
+        kb.add_atoms(("f", str(i)) for i in range(2))
+
+        expected = GroundingSpace([S("a"), E(S("isa"), S("b"), S("c")),
+            E(S("f"), S("0")), E(S("f"), S("1"))])
+        self.assertEqual(kb, expected)
+
+    def test_groundingspace_serialize(self):
+        kb = GroundingSpace()
+        kb.add_atoms(atoms_from_tuples([("isa", "$x", "color"), "red"]))
+
+        copy = GroundingSpace()
+        copy.deserialize(kb.serialize())
+
+        self.assertEqual(copy, kb)
+        self.assertEqual(deserialize_atoms(kb.serialize()), kb.get_content())
+
+    def test_groundingspace_deserialize_rejects_strided_buffer(self):
+        kb = GroundingSpace()
+        kb.add_atoms(atoms_from_tuples([("isa", "$x", "color"), "red"]))
+        strided = memoryview(kb.serialize() * 2)[::2]
+
+        with self.assertRaises(BufferError):
+            deserialize_atoms(strided)
+        with self.assertRaises(BufferError):
+            GroundingSpace().deserialize(strided)
+
     def test_textspace_get_type(self):
         text = TextSpace()
         self.assertEqual(text.get_type(), TextSpace.TYPE)
@@ -96,6 +158,23 @@ class ApiTest(unittest.TestCase):
         expected.add_atom(E(S("+"), S("1"), S("2")))
         self.assertEqual(kb, expected)
 
+    def test_textspace_tokenizer_is_not_changed_after_construction(self):
+        tokenizer = Tokenizer()
+        copied = TextSpace(tokenizer)
+        shared = TextSpace(tokenizer.freeze())
+        tokenizer.register_token("\\+", lambda token: S("add"))
+        copied.add_string("(+ 1 2)")
+        shared.add_string("(+ 1 2)")
+        kb = GroundingSpace()
+
+        kb.add_from_space(copied)
+        kb.add_from_space(shared)
+
+        expected = GroundingSpace()
+        expected.add_atom(E(S("+"), S("1"), S("2")))
+        expected.add_atom(E(S("+"), S("1"), S("2")))
+        self.assertEqual(kb, expected)
+
 class X2Atom(GroundedAtom):
 
     def __init__(self):
@@ -109,3 +188,20 @@ class X2Atom(GroundedAtom):
 
     def __repr__(self):
         return "*2"
+
+class KeepArgsAtom(GroundedAtom):
+
+    def __init__(self):
+        GroundedAtom.__init__(self)
+
+    def execute(self, args, result):
+        # both are read after the interpreter frees its spaces
+        self.args = args.get_content()
+        self.result = result
+        result.add_atom(S("done"))
+
+    def __eq__(self, other):
+        return self is other
+
+    def __repr__(self):
+        return "keep-args"
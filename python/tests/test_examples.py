@@ -259,6 +259,20 @@ class ExamplesTest(unittest.TestCase):
         result = interpret_until_result(target, kb)
         self.assertEqual(repr(result), 'True')
 
+    def test_native_operations(self):
+        atomese = Atomese(native=True)
+        kb = atomese.parse('''
+            (= (if True $then $else) $then)
+            (= (if False $then $else) $else)
+            (= (fact $n) (if (< $n 1) 1 (* (fact (- $n 1)) $n)))
+        ''')
+        target = atomese.parse('(and (not False) (== (fact 5) 120))')
+
+        result = interpret_until_result(target, kb)
+
+        self.assertEqual(result, Bool(True))
+        self.assertEqual(interpret_until_result(atomese.parse('(fact 5)'), kb).value, 120)
+
 class SomeObject():
 
     def foo(self):
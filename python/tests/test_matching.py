@@ -30,6 +30,39 @@ class MatchingTest(unittest.TestCase):
 
         self.assertEqual(result, ValueAtom(3))
 
+    def test_match_bindings(self):
+        kb = GroundingSpace()
+        kb.add_atoms([("isa", "Fred", "frog"), ("isa", "Tweety", "bird")])
+
+        results = kb.match(E(S("isa"), V("x"), V("y")))
+
+        self.assertEqual(len(results), 2)
+        self.assertEqual(results[0]["x"], S("Fred"))
+        self.assertEqual(results[1]["y"], S("bird"))
+        self.assertEqual(sorted(results[0].keys()), ["x", "y"])
+        self.assertFalse("z" in results[0])
+        self.assertEqual(repr(results[1]), "{$x: Tweety, $y: bird}")
+
+    def test_match_iter(self):
+        kb = GroundingSpace()
+        kb.add_atoms(("isa", "frog" + str(i), "frog") for i in range(100))
+
+        first = next(kb.match_iter(E(S("isa"), V("x"), S("frog"))))
+        limited = list(kb.match_iter(E(S("isa"), V("x"), S("frog")), limit=3))
+
+        self.assertEqual(first["x"], S("frog0"))
+        self.assertEqual([b["x"] for b in limited], [S("frog0"), S("frog1"), S("frog2")])
+
+    def test_match_iter_stops_after_first_match(self):
+        kb = GroundingSpace()
+        kb.add_atoms(("isa", "frog" + str(i), "frog") for i in range(100000))
+        Metrics.reset()
+
+        first = next(kb.match_iter(E(S("isa"), V("x"), S("frog"))))
+
+        self.assertEqual(first["x"], S("frog0"))
+        self.assertEqual(Metrics.get_snapshot().candidates_examined, 1)
+
     def test_nested_matching(self):
         Logger.setLevel(Logger.TRACE)
         kb = self.atomese.parse('''
@@ -0,0 +1,111 @@
+import unittest
+import threading
+import time
+
+from hyperon import *
+from common import interpret_until_result, Atomese
+
+def run_in_threads(count, func):
+    results = [None] * count
+    def run(i):
+        results[i] = func()
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(count)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return results
+
+def run_together(*funcs):
+    threads = [threading.Thread(target=func) for func in funcs]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+class ThreadsTest(unittest.TestCase):
+
+    def test_interpret_in_parallel_threads(self):
+        atomese = Atomese()
+        kb = atomese.parse('''
+            (= (if True $then $else) $then)
+            (= (if False $then $else) $else)
+            (= (fact $n) (if (== $n 0) 1 (* (fact (- $n 1)) $n)))
+        ''')
+
+        def fact():
+            target = atomese.parse('(fact 5)')
+            return interpret_until_result(target, kb)
+
+        results = run_in_threads(4, fact)
+
+        self.assertEqual(results, [ValueAtom(120)] * 4)
+
+    def test_parse_with_python_tokens_in_parallel(self):
+        program = "".join("(isa obj{} {})\n".format(i, i) for i in range(1000))
+        tokenizer = Tokenizer()
+        tokenizer.register_token("\\d+", lambda token: ValueAtom(int(token)))
+        text = TextSpace(tokenizer)
+        text.set_threads(4)
+        text.add_string(program)
+        kb = GroundingSpace()
+
+        kb.add_from_space(text)
+
+        content = kb.get_content()
+        self.assertEqual(len(content), 1000)
+        self.assertEqual(content[999], E(S("isa"), S("obj999"), ValueAtom(999)))
+
+    def test_add_and_match_same_space_concurrently(self):
+        kb = GroundingSpace()
+        kb.add_atoms([E(S("isa"), S("obj{}".format(i)), S("class"))
+            for i in range(1000)])
+        pattern = E(S("isa"), V("x"), S("class"))
+        counts = []
+
+        def add():
+            for i in range(1000, 2000):
+                kb.add_atom(E(S("isa"), S("obj{}".format(i)), S("class")))
+
+        def match():
+            for _ in range(20):
+                counts.append(len(kb.match(pattern)))
+                counts.append(sum(1 for _ in kb.match_iter(pattern)))
+
+        run_together(add, match)
+
+        self.assertTrue(all(1000 <= count <= 2000 for count in counts))
+        self.assertEqual(len(kb.get_content()), 2000)
+        self.assertEqual(len(kb.match(pattern)), 2000)
+
+    def test_add_while_long_match_runs(self):
+        kb = GroundingSpace()
+        kb.add_atoms(("isa", "obj{}".format(i), "class") for i in range(300000))
+        pattern = E(S("isa"), V("x"), S("unknown"))
+        windows = []
+        added = []
+        done = threading.Event()
+
+        def match():
+            for _ in range(3):
+                start = time.monotonic()
+                kb.match(pattern)
+                windows.append((start, time.monotonic()))
+            done.set()
+
+        def add():
+            while not done.is_set():
+                kb.add_atom(E(S("isa"), S("new"), S("class")))
+                added.append(time.monotonic())
+
+        run_together(match, add)
+
+        # atoms are added in the middle of each match, so the match doesn't
+        # hold the GIL and doesn't block changes of the space
+        for start, end in windows:
+            quarter = (end - start) / 4
+            self.assertTrue(any(start + quarter < t < end - quarter for t in added))
+        self.assertEqual(len(kb.get_content()), 300000 + len(added))
+
+if __name__ == "__main__":
+    unittest.main()